@@ -0,0 +1,106 @@
+/**
+ * Micro-benchmark helpers shared by the bench/ programs.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Prevent the compiler from optimizing away a computed value
+template<typename T>
+static inline void keep(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Run a function 'rounds' times and return the elapsed time in nanoseconds
+ * @param rounds The number of rounds
+ * @param fun The function to be called, once per round
+ * @return The elapsed time, in nanoseconds
+ */
+template<typename F>
+static uint64_t run(const std::size_t rounds, F&& fun)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; i++) {
+        fun();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+// Print a "reference vs candidate" timing line, with the speedup factor
+static inline void report(const std::string& name, uint64_t elapsed_ref, uint64_t elapsed, std::size_t ops)
+{
+    const auto factor = elapsed != 0 ? (elapsed_ref * 100) / elapsed : 0;
+    std::cerr << name << ": " << (double(elapsed_ref) / ops) << "ns -> " << (double(elapsed) / ops)
+              << "ns per op, factor: " << (factor / 100) << "." << (factor % 100 < 10 ? "0" : "") << (factor % 100)
+              << "\n";
+}
+
+// Deterministic pseudo-random generator (xorshift64*), so that runs can be compared
+class prng
+{
+public:
+    explicit prng(uint64_t seed = 0x9e3779b97f4a7c15)
+      : _state(seed != 0 ? seed : 1)
+    {}
+
+    uint64_t operator()()
+    {
+        _state ^= _state >> 12;
+        _state ^= _state << 25;
+        _state ^= _state >> 27;
+        return _state * 0x2545f4914f6cdd1d;
+    }
+
+    // Uniform value in [0, max)
+    uint64_t below(uint64_t max) { return (__uint128_t((*this)()) * max) >> 64; }
+
+private:
+    uint64_t _state;
+};
+
+// Random printable string of the given size
+static inline std::string random_string(prng& rnd, std::size_t size)
+{
+    std::string str(size, ' ');
+    for (auto& c : str) {
+        c = 'a' + rnd.below(26);
+    }
+    return str;
+}
+
+/**
+ * Load a WORD("...") list from the include/ directory
+ * @comment Done at runtime: the full 63k-word list takes minutes to compile as code
+ * @param name The list file name, such as "words.h"
+ * @return The words, in order
+ */
+static inline std::vector<std::string> load_words(const std::string& name)
+{
+    std::ifstream file(std::string(STRINGSWITCH_SOURCE_DIR) + "/include/" + name);
+    std::vector<std::string> words;
+    for (std::string line; std::getline(file, line);) {
+        if (line.compare(0, 6, "WORD(\"") == 0 && line.size() >= 9) {
+            words.push_back(line.substr(6, line.size() - 9));
+        }
+    }
+    if (words.empty()) {
+        std::cerr << "could not load " << name << "\n";
+        std::abort();
+    }
+    return words;
+}
+
+} // namespace bench
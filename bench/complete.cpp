@@ -0,0 +1,158 @@
+/**
+ * Benchmark: top-k prefix completions with keyword_completer, vs. a linear scan and a std::map range scan.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../fnv1a_complete.h"
+#include "bench.h"
+
+// Allocated bytes (malloc overhead excluded), for the std::set footprint
+static std::size_t allocated = 0;
+
+template<typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() = default;
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&)
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        allocated += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        allocated -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const counting_allocator<U>&) const
+    {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(const counting_allocator<U>&) const
+    {
+        return false;
+    }
+};
+
+// Reference: linear scan of the list, whose first keywords rank first
+static std::size_t linear(const std::vector<std::string>& words,
+                          std::string_view prefix,
+                          std::size_t k,
+                          std::vector<std::string_view>& out)
+{
+    out.clear();
+    for (const auto& word : words) {
+        if (word.size() >= prefix.size() && word.compare(0, prefix.size(), prefix) == 0
+            && std::find(out.begin(), out.end(), word) == out.end()) {
+            out.push_back(word);
+            if (out.size() == k) {
+                break;
+            }
+        }
+    }
+    return out.size();
+}
+
+// Reference: sorted map range, then the top-k ranks
+static std::size_t ranged(const std::map<std::string, uint32_t>& words,
+                          const std::string& prefix,
+                          std::size_t k,
+                          std::vector<std::pair<uint32_t, std::string_view>>& out)
+{
+    out.clear();
+    for (auto it = words.lower_bound(prefix); it != words.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+         ++it) {
+        out.emplace_back(it->second, it->first);
+    }
+    const std::size_t count = std::min(k, out.size());
+    std::partial_sort(out.begin(), out.begin() + count, out.end());
+    out.resize(count);
+    return count;
+}
+
+int main()
+{
+    const std::vector<std::string> words = bench::load_words("words.h");
+
+    std::unique_ptr<keyword_completer> completer;
+    const uint64_t elapsed_build = bench::run(1, [&] { completer = std::make_unique<keyword_completer>(words); });
+    std::map<std::string, uint32_t> map;
+    for (std::size_t i = 0; i < words.size(); i++) {
+        map.emplace(words[i], uint32_t(i));
+    }
+    using counted_string = std::basic_string<char, std::char_traits<char>, counting_allocator<char>>;
+    using counted_set = std::set<counted_string, std::less<counted_string>, counting_allocator<counted_string>>;
+    auto set = std::make_unique<counted_set>();
+    for (const auto& word : words) {
+        set->emplace(word.data(), word.size());
+    }
+    std::cerr << "index: " << completer->size() << " keywords, built in " << (elapsed_build / 1000000) << "ms, "
+              << (completer->memory() >> 10) << "KB (std::set<std::string>: " << (allocated >> 10) << "KB)\n";
+
+    // Prefixes of 1 to 6 bytes, and a few misses
+    bench::prng rnd;
+    std::vector<std::string> prefixes;
+    for (std::size_t i = 0; i < 1000; i++) {
+        const std::string& word = words[rnd.below(words.size())];
+        prefixes.push_back(rnd.below(16) == 0 ? bench::random_string(rnd, 4)
+                                              : word.substr(0, 1 + rnd.below(std::min<std::size_t>(word.size(), 6))));
+    }
+
+    // Check
+    const std::size_t k = 10;
+    std::vector<std::string_view> expected;
+    std::vector<std::pair<uint32_t, std::string_view>> expected_ranged;
+    for (const auto& prefix : prefixes) {
+        const auto found = completer->complete(prefix, k);
+        linear(words, prefix, k, expected);
+        ranged(map, prefix, k, expected_ranged);
+        bool same = found == expected && found.size() == expected_ranged.size();
+        for (std::size_t i = 0; same && i < found.size(); i++) {
+            same = found[i] == expected_ranged[i].second;
+        }
+        if (!same) {
+            std::cerr << "completion mismatch for " << prefix << "\n";
+            std::abort();
+        }
+    }
+
+    const std::size_t rounds = 100;
+    const uint64_t elapsed_linear = bench::run(1, [&] {
+        for (const auto& prefix : prefixes) {
+            bench::keep(linear(words, prefix, k, expected));
+        }
+    });
+    const uint64_t elapsed_ranged = bench::run(1, [&] {
+        for (const auto& prefix : prefixes) {
+            bench::keep(ranged(map, prefix, k, expected_ranged));
+        }
+    });
+    const uint64_t elapsed = bench::run(rounds, [&] {
+        for (const auto& prefix : prefixes) {
+            const auto on_completion = [](std::size_t index, std::string_view) { bench::keep(index); };
+            bench::keep(completer->complete(prefix, k, on_completion));
+        }
+    });
+    bench::report("linear scan vs keyword_completer", elapsed_linear * rounds, elapsed, rounds * prefixes.size());
+    bench::report("std::map range vs keyword_completer", elapsed_ranged * rounds, elapsed, rounds * prefixes.size());
+    return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * Benchmark: single-pass hash of NUL-terminated strings vs strlen-then-hash.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../switch_fnv1a.h"
+#include "bench.h"
+
+template<size_t Bits>
+static void bench_bits()
+{
+    bench::prng rnd;
+    for (std::size_t size = 8; size <= 512; size *= 2) {
+        // Various alignments, to exercise the head of the aligned loop
+        std::vector<std::string> strings;
+        for (std::size_t i = 0; i < 64; i++) {
+            strings.push_back(bench::random_string(rnd, size + (i % 8)));
+        }
+        std::vector<const char*> ptrs;
+        for (std::size_t i = 0; i < strings.size(); i++) {
+            ptrs.push_back(strings[i].c_str() + (i % 8));
+        }
+
+        // Check
+        for (const char* s : ptrs) {
+            std::size_t len = 0;
+            if (fnv1a<Bits>::hash_cstr(s, &len) != fnv1a<Bits>::hash(s, __builtin_strlen(s))
+                || len != __builtin_strlen(s)) {
+                std::cerr << "hash mismatch for " << s << "\n";
+                std::abort();
+            }
+        }
+
+        const std::size_t rounds = 1 + (1 << 20) / size;
+        const uint64_t elapsed_ref = bench::run(rounds, [&] {
+            for (const char* s : ptrs) {
+                bench::keep(s);
+                bench::keep(fnv1a<Bits>::hash(s, __builtin_strlen(s)));
+            }
+        });
+        const uint64_t elapsed = bench::run(rounds, [&] {
+            for (const char* s : ptrs) {
+                bench::keep(s);
+                bench::keep(fnv1a<Bits>::hash_cstr(s));
+            }
+        });
+        bench::report("fnv1a" + std::to_string(Bits) + " strlen+hash vs hash_cstr, " + std::to_string(size) + "B",
+                      elapsed_ref,
+                      elapsed,
+                      rounds * ptrs.size());
+    }
+}
+
+int main()
+{
+    bench_bits<32>();
+    bench_bits<64>();
+    bench_bits<128>();
+    return 0;
+}
@@ -0,0 +1,157 @@
+/**
+ * Benchmark: hashing through the decoding adapters (strhash_percent, strhash_json, strhash_trim) vs. decoding into a
+ * temporary string, then hashing it.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../switch_fnv1a.h"
+#include "bench.h"
+
+// Reference percent-decoder
+static std::string percent_decode(const std::string& s)
+{
+    std::string out;
+    for (std::size_t j = 0; j < s.size(); j++) {
+        if (s[j] == '%' && j + 2 < s.size() && strhash_detail::hex(s[j + 1]) >= 0
+            && strhash_detail::hex(s[j + 2]) >= 0) {
+            out += char(strhash_detail::hex(s[j + 1]) * 16 + strhash_detail::hex(s[j + 2]));
+            j += 2;
+        } else {
+            out += s[j];
+        }
+    }
+    return out;
+}
+
+// Reference UTF-8 encoder
+static void append_utf8(std::string& out, long cp)
+{
+    if (cp < 0x80) {
+        out += char(cp);
+    } else if (cp < 0x800) {
+        out += char(0xc0 | (cp >> 6));
+        out += char(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        out += char(0xe0 | (cp >> 12));
+        out += char(0x80 | ((cp >> 6) & 0x3f));
+        out += char(0x80 | (cp & 0x3f));
+    } else {
+        out += char(0xf0 | (cp >> 18));
+        out += char(0x80 | ((cp >> 12) & 0x3f));
+        out += char(0x80 | ((cp >> 6) & 0x3f));
+        out += char(0x80 | (cp & 0x3f));
+    }
+}
+
+// Reference JSON unescaper
+static std::string json_unescape(const std::string& s)
+{
+    std::string out;
+    for (std::size_t j = 0; j < s.size(); j++) {
+        if (s[j] != '\\' || j + 1 == s.size()) {
+            out += s[j];
+            continue;
+        }
+        const char c = s[j + 1];
+        const char* const simple = "\"\"\\\\//b\bf\fn\nr\rt\t";
+        bool done = false;
+        for (std::size_t i = 0; simple[i] != 0; i += 2) {
+            if (simple[i] == c) {
+                out += simple[i + 1];
+                j++;
+                done = true;
+                break;
+            }
+        }
+        if (done) {
+            continue;
+        }
+        long cp = c == 'u' && j + 6 <= s.size() ? strhash_detail::hex4(&s[j + 2]) : -1;
+        if (cp < 0) {
+            out += '\\';
+            continue;
+        }
+        j += 5;
+        if (cp >= 0xd800 && cp < 0xdc00 && j + 7 <= s.size() && s[j + 1] == '\\' && s[j + 2] == 'u') {
+            const long low = strhash_detail::hex4(&s[j + 3]);
+            if (low >= 0xdc00 && low < 0xe000) {
+                cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                j += 6;
+            }
+        }
+        append_utf8(out, cp);
+    }
+    return out;
+}
+
+// Trim reference
+static std::string trim(const std::string& s)
+{
+    const auto from = s.find_first_not_of(" \t\r\n");
+    if (from == std::string::npos) {
+        return "";
+    }
+    return s.substr(from, s.find_last_not_of(" \t\r\n") - from + 1);
+}
+
+template<typename D, typename A>
+static void compare(const std::string& name, const std::vector<std::string>& strings, D&& decode, A&& adapter)
+{
+    for (const auto& str : strings) {
+        if (strhash::hash(decode(str)) != adapter(str)) {
+            std::cerr << name << ": hash mismatch for " << str << "\n";
+            std::abort();
+        }
+    }
+
+    const std::size_t rounds = 20000;
+    const uint64_t elapsed_ref = bench::run(rounds, [&] {
+        for (const auto& str : strings) {
+            bench::keep(strhash::hash(decode(str)));
+        }
+    });
+    const uint64_t elapsed = bench::run(rounds, [&] {
+        for (const auto& str : strings) {
+            bench::keep(adapter(str));
+        }
+    });
+    bench::report(name, elapsed_ref, elapsed, rounds * strings.size());
+}
+
+int main()
+{
+    bench::prng rnd;
+    for (const std::size_t size : { 8, 32, 128 }) {
+        std::vector<std::string> paths, keys, padded;
+        for (std::size_t i = 0; i < 64; i++) {
+            std::string path = bench::random_string(rnd, size);
+            std::string key = path;
+            // A few escapes
+            for (std::size_t j = 0; j < 1 + size / 32; j++) {
+                const std::size_t at = rnd.below(path.size());
+                path.replace(at, 1, "%2F");
+                key.replace(at, 1, j % 2 == 0 ? "\\n" : "\\u00e9");
+            }
+            paths.push_back(path);
+            keys.push_back(key);
+            padded.push_back("  " + path + " \n");
+        }
+        const std::string suffix = ", " + std::to_string(size) + "B";
+        compare("percent decode+hash vs strhash_percent" + suffix,
+                paths,
+                percent_decode,
+                [](const std::string& s) { return strhash_percent::hash(s); });
+        compare("json unescape+hash vs strhash_json" + suffix, keys, json_unescape, [](const std::string& s) {
+            return strhash_json::hash(s);
+        });
+        compare("trim+hash vs strhash_trim" + suffix, padded, trim, [](const std::string& s) {
+            return strhash_trim::hash(s);
+        });
+    }
+    return 0;
+}
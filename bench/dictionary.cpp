@@ -0,0 +1,97 @@
+/**
+ * Benchmark: dictionary encoding of a Zipf-distributed string column with dictionary_encoder, vs.
+ * std::unordered_map<std::string, uint32_t>.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../fnv1a_dictionary.h"
+#include "bench.h"
+
+// Reference encoder
+static std::size_t reference(const string_column& column, uint32_t* codes)
+{
+    std::unordered_map<std::string, uint32_t> map;
+    std::string value;
+    for (std::size_t i = 0; i < column.rows; i++) {
+        value.assign(column[i]);
+        codes[i] = map.emplace(value, uint32_t(map.size())).first->second;
+    }
+    return map.size();
+}
+
+static void report_bytes(const std::string& name, uint64_t elapsed, std::size_t bytes)
+{
+    std::cerr << "  " << name << ": " << (double(bytes) / elapsed) << "GB/s\n";
+}
+
+int main()
+{
+    const std::vector<std::string> words = bench::load_words("words.h");
+
+    // Zipf (s = 1) over the words, drawn in list order of rank
+    std::vector<double> cdf(words.size());
+    double total = 0;
+    for (std::size_t i = 0; i < words.size(); i++) {
+        total += 1.0 / double(i + 1);
+        cdf[i] = total;
+    }
+    const std::size_t rows = std::size_t(1) << 24;
+    bench::prng rnd;
+    std::vector<int32_t> offsets = { 0 };
+    std::string bytes;
+    for (std::size_t i = 0; i < rows; i++) {
+        const double u = double(rnd() >> 11) / double(uint64_t(1) << 53) * total;
+        const std::size_t rank = std::min<std::size_t>(std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin(),
+                                                        words.size() - 1);
+        bytes += words[rank];
+        offsets.push_back(int32_t(bytes.size()));
+    }
+    const string_column column = { offsets.data(), bytes.data(), rows };
+
+    std::vector<uint32_t> expected(rows);
+    std::size_t distinct = 0;
+    const uint64_t elapsed_ref = bench::run(1, [&] { distinct = reference(column, expected.data()); });
+
+    std::vector<uint32_t> codes(rows);
+    dictionary_encoder<64> encoder;
+    const uint64_t elapsed = bench::run(1, [&] { encoder.encode(column, codes.data()); });
+    dictionary_encoder<128> encoder128;
+    const uint64_t elapsed128 = bench::run(1, [&] { encoder128.encode(column, codes.data()); });
+
+    // The parallel variant must yield the same codes and dictionary
+    const unsigned threads = std::max(4u, std::thread::hardware_concurrency());
+    dictionary_encoder<64> parallel;
+    const uint64_t elapsed_parallel = bench::run(1, [&] { parallel.encode_parallel(column, codes.data(), threads); });
+    if (codes != expected || encoder.size() != distinct || parallel.size() != distinct) {
+        std::cerr << "code mismatch\n";
+        std::abort();
+    }
+    for (std::size_t i = 0; i < rows; i++) {
+        if (parallel.dictionary()[codes[i]] != column[i]) {
+            std::cerr << "dictionary mismatch\n";
+            std::abort();
+        }
+    }
+
+    std::cerr << rows << " rows, " << (bytes.size() >> 20) << "MB, " << distinct << " distinct values\n";
+    bench::report("std::unordered_map vs dictionary_encoder<64>", elapsed_ref, elapsed, rows);
+    bench::report("std::unordered_map vs dictionary_encoder<128>", elapsed_ref, elapsed128, rows);
+    bench::report("std::unordered_map vs dictionary_encoder<64>, " + std::to_string(threads) + " threads",
+                  elapsed_ref,
+                  elapsed_parallel,
+                  rows);
+    report_bytes("std::unordered_map", elapsed_ref, bytes.size());
+    report_bytes("dictionary_encoder<64>", elapsed, bytes.size());
+    report_bytes("dictionary_encoder<128>", elapsed128, bytes.size());
+    report_bytes("dictionary_encoder<64>, " + std::to_string(threads) + " threads", elapsed_parallel, bytes.size());
+    return 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * Benchmark: blocked_bloom_filter and cuckoo_filter over fnv1a64/fnv1a128 hashes (false positives, bits per key,
+ * lookups per second), vs. a std::unordered_set of the 64-bit hashes.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../fnv1a_filter.h"
+#include "bench.h"
+
+// Allocated bytes (malloc overhead excluded), for the std::unordered_set footprint
+static std::size_t allocated = 0;
+
+template<typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() = default;
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&)
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        allocated += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        allocated -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const counting_allocator<U>&) const
+    {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(const counting_allocator<U>&) const
+    {
+        return false;
+    }
+};
+
+// Check, then measure a filter: scalar and batch lookups over present and absent keys
+template<typename Filter, typename H>
+static void measure(const std::string& name,
+                    const Filter& filter,
+                    const std::vector<H>& present,
+                    const std::vector<H>& absent)
+{
+    std::unique_ptr<bool[]> out(new bool[absent.size()]);
+    filter.contains(present.data(), present.size(), out.get());
+    for (std::size_t i = 0; i < present.size(); i++) {
+        if (!out[i] || !filter.contains(present[i])) {
+            std::cerr << name << ": false negative\n";
+            std::abort();
+        }
+    }
+
+    std::size_t positives = 0;
+    const uint64_t elapsed = bench::run(1, [&] {
+        for (const H& hash : absent) {
+            positives += filter.contains(hash);
+        }
+    });
+    std::size_t batch_positives = 0;
+    const uint64_t elapsed_batch = bench::run(1, [&] {
+        filter.contains(absent.data(), absent.size(), out.get());
+        for (std::size_t i = 0; i < absent.size(); i++) {
+            batch_positives += out[i];
+        }
+    });
+    if (positives != batch_positives) {
+        std::cerr << name << ": batch mismatch\n";
+        std::abort();
+    }
+    std::cerr << name << ": " << (double(filter.memory()) * 8 / present.size()) << " bits/key, "
+              << (double(positives) * 100 / absent.size()) << "% false positives, "
+              << (double(absent.size()) * 1000 / elapsed) << "M lookups/s, "
+              << (double(absent.size()) * 1000 / elapsed_batch) << "M lookups/s (batch)\n";
+}
+
+int main()
+{
+    const std::size_t keys = 10000000;
+    std::vector<fnv1a64::Type> present64, absent64;
+    std::vector<fnv1a128::Type> present128, absent128;
+    for (std::size_t i = 0; i < keys; i++) {
+        const std::string key = "user:" + std::to_string(i);
+        const std::string other = "user:" + std::to_string(keys + i);
+        present64.push_back(fnv1a64::hash(key));
+        absent64.push_back(fnv1a64::hash(other));
+        present128.push_back(fnv1a128::hash(key));
+        absent128.push_back(fnv1a128::hash(other));
+    }
+
+    for (const double bits : { 8.0, 12.0, 16.0 }) {
+        blocked_bloom_filter bloom64(keys, bits);
+        blocked_bloom_filter bloom128(keys, bits);
+        for (std::size_t i = 0; i < keys; i++) {
+            bloom64.insert(present64[i]);
+            bloom128.insert(present128[i]);
+        }
+        measure("blocked_bloom_filter, fnv1a64", bloom64, present64, absent64);
+        measure("blocked_bloom_filter, fnv1a128", bloom128, present128, absent128);
+    }
+
+    cuckoo_filter cuckoo64(keys);
+    cuckoo_filter cuckoo128(keys);
+    for (std::size_t i = 0; i < keys; i++) {
+        if (!cuckoo64.insert(present64[i]) || !cuckoo128.insert(present128[i])) {
+            std::cerr << "cuckoo_filter full at " << i << " keys\n";
+            std::abort();
+        }
+    }
+    measure("cuckoo_filter, fnv1a64", cuckoo64, present64, absent64);
+    measure("cuckoo_filter, fnv1a128", cuckoo128, present128, absent128);
+
+    // Deletion: the remaining keys are still found
+    for (std::size_t i = 0; i < keys; i += 2) {
+        if (!cuckoo64.erase(present64[i])) {
+            std::cerr << "cuckoo_filter: erase failed\n";
+            std::abort();
+        }
+    }
+    for (std::size_t i = 1; i < keys; i += 2) {
+        if (!cuckoo64.contains(present64[i])) {
+            std::cerr << "cuckoo_filter: false negative after erase\n";
+            std::abort();
+        }
+    }
+
+    // Reference: exact set of the 64-bit hashes
+    std::unordered_set<uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, counting_allocator<uint64_t>> set(
+      present64.begin(), present64.end());
+    std::size_t found = 0;
+    const uint64_t elapsed = bench::run(1, [&] {
+        for (const auto& hash : absent64) {
+            found += set.count(hash);
+        }
+    });
+    std::cerr << "std::unordered_set<uint64_t>: " << (double(allocated) * 8 / keys) << " bits/key, "
+              << (double(found) * 100 / keys) << "% false positives, " << (double(keys) * 1000 / elapsed)
+              << "M lookups/s\n";
+    return 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * Benchmark: group-by aggregation of a string column with string_group_by, vs. std::unordered_map<std::string, Agg>.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../fnv1a_groupby.h"
+#include "bench.h"
+
+// Reference aggregate
+struct agg
+{
+    uint64_t count = 0;
+    int64_t sum = 0;
+    int64_t min = std::numeric_limits<int64_t>::max();
+    int64_t max = std::numeric_limits<int64_t>::lowest();
+};
+
+static std::unordered_map<std::string, agg> reference(const string_column& keys, const int64_t* values)
+{
+    std::unordered_map<std::string, agg> map;
+    std::string key;
+    for (std::size_t i = 0; i < keys.rows; i++) {
+        key.assign(keys[i]);
+        agg& a = map[key];
+        a.count++;
+        a.sum += values[i];
+        a.min = std::min(a.min, values[i]);
+        a.max = std::max(a.max, values[i]);
+    }
+    return map;
+}
+
+template<std::size_t Bits>
+static void check(const string_group_by<int64_t, Bits>& group_by, const std::unordered_map<std::string, agg>& map)
+{
+    const auto& aggregates = group_by.aggregates();
+    bool same = group_by.groups().size() == map.size();
+    for (uint32_t id = 0; same && id < group_by.groups().size(); id++) {
+        const auto it = map.find(std::string(group_by.groups().key(id)));
+        same = it != map.end() && it->second.count == aggregates.count[id] && it->second.sum == aggregates.sum[id]
+               && it->second.min == aggregates.min[id] && it->second.max == aggregates.max[id];
+    }
+    if (!same) {
+        std::cerr << "aggregate mismatch\n";
+        std::abort();
+    }
+}
+
+static void report_rows(const std::string& name, uint64_t elapsed, std::size_t rows)
+{
+    std::cerr << "  " << name << ": " << (double(rows) * 1000 / elapsed) << "M rows/s\n";
+}
+
+int main()
+{
+    const std::size_t rows = std::size_t(1) << 24;
+    bench::prng rnd;
+    std::vector<int64_t> values(rows);
+    for (auto& value : values) {
+        value = int64_t(rnd.below(1000000));
+    }
+
+    // Batch hashing yields the plain hashes
+    {
+        const std::vector<int32_t> offsets = { 0, 3, 3, 10, 11, 30, 31, 32 };
+        const std::string bytes = "abcdefghijklmnopqrstuvwxyz0123456789";
+        const string_column column = { offsets.data(), bytes.data(), offsets.size() - 1 };
+        fnv1a128::Type hashes[7];
+        hash_column<128>(column, 0, column.rows, hashes);
+        for (std::size_t i = 0; i < column.rows; i++) {
+            if (hashes[i] != fnv1a128::hash(column[i])) {
+                std::cerr << "batch hash mismatch\n";
+                std::abort();
+            }
+        }
+    }
+
+    for (const std::size_t groups : { 10, 10000, 10000000 }) {
+        // Host-like keys, uniformly drawn among 'groups'
+        std::vector<int32_t> offsets = { 0 };
+        std::string bytes;
+        for (std::size_t i = 0; i < rows; i++) {
+            bytes += "host-" + std::to_string(rnd.below(groups)) + ".example.com";
+            offsets.push_back(int32_t(bytes.size()));
+        }
+        const string_column keys = { offsets.data(), bytes.data(), rows };
+
+        std::unordered_map<std::string, agg> map;
+        const uint64_t elapsed_ref = bench::run(1, [&] { map = reference(keys, values.data()); });
+        const std::size_t distinct = map.size();
+
+        string_group_by<int64_t, 64> group_by64;
+        const uint64_t elapsed64 = bench::run(1, [&] { group_by64.add(keys, values.data()); });
+        check(group_by64, map);
+        string_group_by<int64_t, 128> group_by128;
+        const uint64_t elapsed128 = bench::run(1, [&] { group_by128.add(keys, values.data()); });
+        check(group_by128, map);
+        map = {};
+
+        const std::string suffix = ", " + std::to_string(distinct) + " groups";
+        bench::report("std::unordered_map vs string_group_by<64>" + suffix, elapsed_ref, elapsed64, rows);
+        bench::report("std::unordered_map vs string_group_by<128>" + suffix, elapsed_ref, elapsed128, rows);
+        report_rows("std::unordered_map", elapsed_ref, rows);
+        report_rows("string_group_by<64>", elapsed64, rows);
+        report_rows("string_group_by<128>", elapsed128, rows);
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * Benchmark: string hash join with hash_join and partitioned_hash_join, vs. std::unordered_multimap<std::string, ...>.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../fnv1a_join.h"
+#include "bench.h"
+
+// String column builder
+struct column_data
+{
+    std::vector<int32_t> offsets = { 0 };
+    std::vector<int64_t> large_offsets = { 0 };
+    std::string bytes;
+
+    void push_back(const std::string& value)
+    {
+        bytes += value;
+        offsets.push_back(int32_t(bytes.size()));
+        large_offsets.push_back(int64_t(bytes.size()));
+    }
+
+    string_column column() const { return string_column{ offsets.data(), bytes.data(), offsets.size() - 1 }; }
+
+    large_string_column large_column() const
+    {
+        return large_string_column{ large_offsets.data(), bytes.data(), large_offsets.size() - 1 };
+    }
+};
+
+// Order-independent digest of the matches
+struct digest
+{
+    uint64_t count = 0;
+    uint64_t sum = 0;
+
+    void add(const join_match& match)
+    {
+        count++;
+        sum += (match.build * 0x9e3779b97f4a7c15) ^ match.probe;
+    }
+
+    bool operator==(const digest& other) const { return count == other.count && sum == other.sum; }
+};
+
+static digest reference(const string_column& build, const string_column& probe)
+{
+    std::unordered_multimap<std::string, uint64_t> map;
+    for (std::size_t i = 0; i < build.rows; i++) {
+        map.emplace(std::string(build[i]), i);
+    }
+    digest d;
+    std::string key;
+    for (std::size_t i = 0; i < probe.rows; i++) {
+        key.assign(probe[i]);
+        const auto range = map.equal_range(key);
+        for (auto it = range.first; it != range.second; ++it) {
+            d.add(join_match{ it->second, i });
+        }
+    }
+    return d;
+}
+
+int main()
+{
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t probes = std::size_t(1) << 23;
+    bench::prng rnd;
+    for (const std::size_t size : { 1000, 100000, 1000000, 4000000 }) {
+        // Dimension keys, a few of them duplicated; half of the probes miss
+        column_data build;
+        for (std::size_t i = 0; i < size; i++) {
+            build.push_back("dimension-" + std::to_string(rnd.below(16) == 0 ? rnd.below(size) : i));
+        }
+        column_data probe;
+        for (std::size_t i = 0; i < probes; i++) {
+            probe.push_back("dimension-" + std::to_string(rnd.below(size * 2)));
+        }
+
+        digest expected;
+        const uint64_t elapsed_ref = bench::run(1, [&] { expected = reference(build.column(), probe.column()); });
+
+        digest found;
+        const uint64_t elapsed = bench::run(1, [&] {
+            const hash_join join(build.column());
+            join.probe(probe.column(), [&](const join_match& match) { found.add(match); });
+        });
+        digest found_partitioned;
+        const uint64_t elapsed_partitioned = bench::run(1, [&] {
+            for (const auto& match : partitioned_hash_join(build.column(), probe.column(), threads)) {
+                found_partitioned.add(match);
+            }
+        });
+        // 64-bit offsets (large_utf8), joined with 32-bit ones: the same matches
+        digest found_large;
+        const large_hash_join large_join(build.large_column());
+        large_join.probe(probe.large_column(), [&](const join_match& match) { found_large.add(match); });
+        digest found_large_partitioned;
+        for (const auto& match : partitioned_hash_join(build.large_column(), probe.column(), threads)) {
+            found_large_partitioned.add(match);
+        }
+        if (!(found == expected) || !(found_partitioned == expected) || !(found_large == expected) ||
+            !(found_large_partitioned == expected)) {
+            std::cerr << "join mismatch\n";
+            std::abort();
+        }
+
+        const std::string suffix = ", " + std::to_string(size) + " build rows";
+        bench::report("std::unordered_multimap vs hash_join" + suffix, elapsed_ref, elapsed, probes);
+        const std::string threads_suffix = ", " + std::to_string(threads) + " threads" + suffix;
+        bench::report("std::unordered_multimap vs partitioned_hash_join" + threads_suffix,
+                      elapsed_ref,
+                      elapsed_partitioned,
+                      probes);
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * Benchmark: exact + lowercase hashes (and lowercase copy) in a single pass, vs. separate calls.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../switch_fnv1a.h"
+#include "bench.h"
+
+int main()
+{
+    bench::prng rnd;
+    for (std::size_t size = 8; size <= 512; size *= 4) {
+        std::vector<std::string> strings;
+        for (std::size_t i = 0; i < 64; i++) {
+            std::string str = bench::random_string(rnd, size);
+            for (auto& c : str) {
+                if (rnd.below(4) == 0) {
+                    c = c - 'a' + 'A';
+                }
+            }
+            strings.push_back(str);
+        }
+        std::string buffer(size, ' ');
+
+        // Check
+        for (const auto& str : strings) {
+            const auto hashes = strhash_multi::hash(str, &buffer[0]);
+            std::string lower = str;
+            for (auto& c : lower) {
+                c = c >= 'A' && c <= 'Z' ? c + 'a' - 'A' : c;
+            }
+            if (hashes.exact != strhash::hash(str) || hashes.lower != strhash_lower::hash(str) || buffer != lower) {
+                std::cerr << "hash mismatch for " << str << "\n";
+                std::abort();
+            }
+        }
+
+        const std::size_t rounds = 1 + (1 << 18) / size;
+        const std::string suffix = ", " + std::to_string(size) + "B";
+
+        // Two hashes
+        {
+            const uint64_t elapsed_ref = bench::run(rounds, [&] {
+                for (const auto& str : strings) {
+                    bench::keep(strhash::hash(str));
+                    bench::keep(strhash_lower::hash(str));
+                }
+            });
+            const uint64_t elapsed = bench::run(rounds, [&] {
+                for (const auto& str : strings) {
+                    bench::keep(strhash_multi::hash(str));
+                }
+            });
+            bench::report("strhash+strhash_lower vs strhash_multi" + suffix,
+                          elapsed_ref,
+                          elapsed,
+                          rounds * strings.size());
+        }
+
+        // Two hashes, and a lowercase copy
+        {
+            const uint64_t elapsed_ref = bench::run(rounds, [&] {
+                for (const auto& str : strings) {
+                    bench::keep(strhash::hash(str));
+                    bench::keep(strhash_lower::hash(str));
+                    for (std::size_t j = 0; j < str.size(); j++) {
+                        const char c = str[j];
+                        buffer[j] = c >= 'A' && c <= 'Z' ? c + 'a' - 'A' : c;
+                    }
+                    bench::keep(buffer);
+                }
+            });
+            const uint64_t elapsed = bench::run(rounds, [&] {
+                for (const auto& str : strings) {
+                    bench::keep(strhash_multi::hash(str, &buffer[0]));
+                    bench::keep(buffer);
+                }
+            });
+            bench::report("strhash+strhash_lower+copy vs strhash_multi with copy" + suffix,
+                          elapsed_ref,
+                          elapsed,
+                          rounds * strings.size());
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * Benchmark: lookups in a 1M-string symbol_table by threads pinned on every CPU (so on every NUMA node), reading a
+ * single copy vs. the local replica of a numa_replicated table.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "../fnv1a_numa.h"
+#include "../fnv1a_symbol.h"
+#include "bench.h"
+
+// Per-thread result
+struct thread_result
+{
+    int node;
+    uint64_t elapsed;
+};
+
+/**
+ * Run lookups on every CPU
+ * @param cpus The CPUs
+ * @param ids The IDs to look up, in the table of each thread
+ * @param table Function returning the table a thread reads
+ * @return The results, by CPU
+ */
+template<typename F>
+static std::vector<thread_result> run_threads(const std::vector<int>& cpus, const std::vector<uint64_t>& ids, F&& table)
+{
+    std::vector<thread_result> results(cpus.size());
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < cpus.size(); t++) {
+        workers.emplace_back([&, t] {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus[t], &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            // Thread-local copy of the IDs, on the thread's node
+            const std::vector<uint64_t> local(ids);
+            const symbol_table& symbols = table();
+            std::size_t bytes = 0;
+            const uint64_t elapsed = bench::run(1, [&] {
+                for (const uint64_t id : local) {
+                    std::string_view name;
+                    if (symbols.name(id, name)) {
+                        bytes += name.size();
+                    }
+                }
+            });
+            bench::keep(bytes);
+            results[t] = thread_result{ numa_detail::current_node(), elapsed };
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return results;
+}
+
+static void report(const std::string& name, const std::vector<thread_result>& results, std::size_t lookups)
+{
+    std::map<int, std::pair<uint64_t, std::size_t>> nodes;
+    for (const thread_result& r : results) {
+        nodes[r.node].first += r.elapsed;
+        nodes[r.node].second++;
+    }
+    std::cerr << "  " << name << ":";
+    for (const auto& node : nodes) {
+        std::cerr << " node " << node.first << " " << (double(node.second.first) / node.second.second / lookups)
+                  << "ns per lookup (" << node.second.second << " threads);";
+    }
+    std::cerr << "\n";
+}
+
+int main()
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    sched_getaffinity(0, sizeof(set), &set);
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus.push_back(cpu);
+        }
+    }
+
+    // Field names such as "word.word_word", from the words.h list
+    const std::vector<std::string> words = bench::load_words("words.h");
+    bench::prng rnd;
+    std::vector<std::string> fields;
+    for (std::size_t i = 0; i < (std::size_t(1) << 20); i++) {
+        fields.push_back(words[rnd.below(words.size())] + "." + words[rnd.below(words.size())] + "_"
+                         + words[rnd.below(words.size())]);
+    }
+    const std::size_t lookups = std::size_t(1) << 22;
+    std::vector<uint64_t> ids(lookups);
+    for (auto& id : ids) {
+        id = fnv1a64::hash(fields[rnd.below(fields.size())]);
+    }
+
+    const symbol_table single(fields);
+    const numa_replicated<symbol_table> replicated{ symbol_table(fields) };
+    std::cerr << cpus.size() << " CPUs, " << numa_detail::online_nodes().size() << " NUMA nodes ("
+              << replicated.replicas() << " replicas"
+#if defined(FNV1A_LIBNUMA)
+              << ", libnuma"
+#endif
+              << "), " << single.size() << " strings (" << (single.memory() >> 20) << "MB per copy), " << lookups
+              << " lookups per thread\n";
+
+    // Replicas are equal
+    for (std::size_t i = 0; i < 1000; i++) {
+        std::string_view a;
+        std::string_view b;
+        if (!single.name(ids[i], a) || !replicated.local().name(ids[i], b) || a != b) {
+            std::cerr << "replica mismatch\n";
+            std::abort();
+        }
+    }
+
+    report("single copy", run_threads(cpus, ids, [&]() -> const symbol_table& { return single; }), lookups);
+    report("numa_replicated::local()",
+           run_threads(cpus, ids, [&]() -> const symbol_table& { return replicated.local(); }),
+           lookups);
+    return 0;
+}
@@ -0,0 +1,234 @@
+/**
+ * Benchmark: page_options for large tables (fnv1a_memory.h): transparent and explicit huge pages, prefaulting. A 2M-key
+ * hash_join (build time, page faults, probes and their dTLB misses), then a 1M-key shm_intern_table mapped by another
+ * user (mapping time, first-lookup latency and page faults).
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../fnv1a_join.h"
+#include "../fnv1a_shm.h"
+#include "bench.h"
+
+// Minor page faults of the process so far
+static uint64_t page_faults()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return uint64_t(usage.ru_minflt);
+}
+
+// A /proc/meminfo or /proc/self/smaps_rollup value, in KiB
+static uint64_t kernel_value(const char* file, const std::string& name)
+{
+    std::ifstream in(file);
+    for (std::string line; std::getline(in, line);) {
+        if (line.compare(0, name.size(), name) == 0 && line.size() > name.size() && line[name.size()] == ':') {
+            return std::strtoull(line.c_str() + name.size() + 1, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+// dTLB load miss counter (perf_event_open), if the CPU exposes one
+class dtlb_counter
+{
+public:
+    dtlb_counter()
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    ~dtlb_counter()
+    {
+        if (_fd != -1) {
+            close(_fd);
+        }
+    }
+
+    bool valid() const { return _fd != -1; }
+
+    void start()
+    {
+        if (_fd != -1) {
+            ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    uint64_t stop()
+    {
+        uint64_t count = 0;
+        if (_fd != -1) {
+            ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(_fd, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+        return count;
+    }
+
+private:
+    int _fd = -1;
+};
+
+// String column builder
+struct column_data
+{
+    std::vector<int32_t> offsets = { 0 };
+    std::string bytes;
+
+    void push_back(const std::string& value)
+    {
+        bytes += value;
+        offsets.push_back(int32_t(bytes.size()));
+    }
+
+    string_column column() const { return string_column{ offsets.data(), bytes.data(), offsets.size() - 1 }; }
+};
+
+struct variant
+{
+    const char* name;
+    page_options options;
+};
+
+static page_options make_options(bool huge_pages, bool explicit_huge_pages, bool populate)
+{
+    page_options options;
+    options.huge_pages = huge_pages;
+    options.explicit_huge_pages = explicit_huge_pages;
+    options.populate = populate;
+    return options;
+}
+
+int main()
+{
+    const std::vector<variant> variants = {
+        { "default", page_options() },
+        { "populate", make_options(false, false, true) },
+        { "transparent huge pages", make_options(true, false, false) },
+        { "transparent huge pages, populate", make_options(true, false, true) },
+        { "explicit huge pages, populate", make_options(false, true, true) },
+    };
+    dtlb_counter dtlb;
+    std::cerr << "transparent huge pages: "
+              << std::ifstream("/sys/kernel/mm/transparent_hugepage/enabled").rdbuf() << "explicit huge pages: "
+              << kernel_value("/proc/meminfo", "HugePages_Total") << " reserved (explicit falls back to transparent)\n";
+    if (!dtlb.valid()) {
+        std::cerr << "dTLB miss counter unavailable (no PMU access): dTLB misses reported as n/a\n";
+    }
+
+    // Join: 2M build keys, probed with absent keys, so that probes only touch the slot table (by default allocated
+    // with new, aligned on a cache line)
+    const std::size_t size = std::size_t(2) << 20;
+    const std::size_t probes = std::size_t(4) << 20;
+    bench::prng rnd;
+    column_data build;
+    for (std::size_t i = 0; i < size; i++) {
+        build.push_back("dimension-" + std::to_string(i));
+    }
+    column_data probe;
+    for (std::size_t i = 0; i < probes; i++) {
+        probe.push_back("missing-" + std::to_string(rnd.below(size * 4)));
+    }
+    std::cerr << "hash_join, " << size << " build keys, " << probes << " probes:\n";
+    for (const variant& v : variants) {
+        const uint64_t huge_before = kernel_value("/proc/self/smaps_rollup", "AnonHugePages");
+        const uint64_t faults_before = page_faults();
+        std::unique_ptr<hash_join> join;
+        const uint64_t elapsed_build = bench::run(1, [&] { join.reset(new hash_join(build.column(), v.options)); });
+        const uint64_t faults = page_faults() - faults_before;
+        const uint64_t huge = kernel_value("/proc/self/smaps_rollup", "AnonHugePages") - huge_before;
+
+        std::size_t matches = 0;
+        uint64_t elapsed = ~uint64_t(0);
+        uint64_t misses = 0;
+        for (int round = 0; round < 3; round++) {
+            dtlb.start();
+            elapsed = std::min(elapsed, bench::run(1, [&] {
+                                   join->probe(probe.column(), [&](const join_match&) { matches++; });
+                               }));
+            misses = dtlb.stop();
+        }
+        if (matches != 0) {
+            std::cerr << "unexpected match\n";
+            std::abort();
+        }
+        std::cerr << "  " << v.name << ": build " << (double(elapsed_build) / 1e6) << "ms (" << faults
+                  << " page faults, " << (huge >> 10) << "MB in huge pages), " << (double(elapsed) / probes)
+                  << "ns per probe, ";
+        if (dtlb.valid()) {
+            std::cerr << (double(misses) / probes) << " dTLB misses per probe\n";
+        } else {
+            std::cerr << "n/a dTLB misses\n";
+        }
+    }
+
+    // Interning table, created, then mapped again as by another process: first lookups
+    const std::size_t keys = std::size_t(1) << 20;
+    shm_intern_table table = shm_intern_table::create("", keys, keys * 16);
+    if (!table.valid()) {
+        std::cerr << "could not create the interning table\n";
+        return EXIT_FAILURE;
+    }
+    for (std::size_t i = 0; i < keys; i++) {
+        table.intern("label-" + std::to_string(i));
+    }
+    std::vector<std::string> lookups(10000);
+    for (auto& key : lookups) {
+        key = "label-" + std::to_string(rnd.below(keys));
+    }
+    std::cerr << "shm_intern_table, " << keys << " keys, mapped again:\n";
+    for (const variant& v : variants) {
+        if (v.options.explicit_huge_pages) {
+            continue;
+        }
+        const uint64_t faults_before = page_faults();
+        shm_intern_table mapped;
+        const uint64_t elapsed_map =
+          bench::run(1, [&] { mapped = shm_intern_table::attach(dup(table.fd()), v.options); });
+        const uint64_t faults_map = page_faults() - faults_before;
+        uint32_t id = 0;
+        const uint64_t elapsed_first = bench::run(1, [&] { id = mapped.find(lookups[0]); });
+        const uint64_t faults_first = page_faults() - faults_before - faults_map;
+        const uint64_t elapsed = bench::run(1, [&] {
+            for (const std::string& key : lookups) {
+                id |= mapped.find(key);
+            }
+        });
+        const uint64_t faults = page_faults() - faults_before - faults_map - faults_first;
+        if (id == shm_intern_table::npos) {
+            std::cerr << "missing key\n";
+            std::abort();
+        }
+        std::cerr << "  " << v.name << ": mapping " << (double(elapsed_map) / 1000) << "us (" << faults_map
+                  << " page faults), first lookup " << (double(elapsed_first) / 1000) << "us (" << faults_first
+                  << " page faults), next " << lookups.size() << " lookups " << (double(elapsed) / lookups.size())
+                  << "ns each (" << faults << " page faults)\n";
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * Benchmark: radix partitioning of hashed rows with radix_partitioner, vs. a naive row-by-row scatter.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../fnv1a_partition.h"
+#include "bench.h"
+
+// Reference: histogram, then a direct scatter of every row
+static void naive(const uint64_t* hashes, std::size_t rows, unsigned bits, std::vector<hashed_row>& out)
+{
+    std::vector<std::size_t> next(std::size_t(1) << bits, 0);
+    for (std::size_t i = 0; i < rows; i++) {
+        next[fnv1a_index::mixed(hashes[i], bits)]++;
+    }
+    for (std::size_t p = 0, offset = 0; p < next.size(); p++) {
+        const std::size_t size = next[p];
+        next[p] = offset;
+        offset += size;
+    }
+    for (std::size_t i = 0; i < rows; i++) {
+        out[next[fnv1a_index::mixed(hashes[i], bits)]++] = hashed_row{ hashes[i], i };
+    }
+}
+
+static void report_rows(const std::string& name, uint64_t elapsed, std::size_t rows)
+{
+    std::cerr << "  " << name << ": " << (double(rows) * 1000 / elapsed) << "M rows/s\n";
+}
+
+int main()
+{
+    const std::vector<std::string> words = bench::load_words("words.h");
+
+    // Keys: "word word"
+    const std::size_t rows = std::size_t(1) << 24;
+    bench::prng rnd;
+    std::vector<int32_t> offsets = { 0 };
+    std::string bytes;
+    for (std::size_t i = 0; i < rows; i++) {
+        bytes += words[rnd.below(words.size())] + " " + words[rnd.below(words.size())];
+        offsets.push_back(int32_t(bytes.size()));
+    }
+    const string_column column = { offsets.data(), bytes.data(), rows };
+    std::vector<uint64_t> hashes(rows);
+    hash_column<64>(column, 0, rows, hashes.data());
+
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<hashed_row> expected(rows);
+    for (unsigned bits = 4; bits <= 14; bits += 2) {
+        const uint64_t elapsed_ref = bench::run(1, [&] { naive(hashes.data(), rows, bits, expected); });
+        radix_partitioner partitioner(bits);
+        partitioner.partition(hashes.data(), rows); // Warm-up: output allocation
+        const uint64_t elapsed = bench::run(1, [&] { partitioner.partition(hashes.data(), rows); });
+
+        // Same stable output, whatever the number of threads
+        for (const unsigned t : { 1u, 3u }) {
+            radix_partitioner check(bits);
+            check.partition(hashes.data(), rows, t);
+            for (std::size_t i = 0; i < rows; i++) {
+                const hashed_row& row = check.begin(0)[i];
+                if (row.hash != expected[i].hash || row.row != expected[i].row) {
+                    std::cerr << "partition mismatch\n";
+                    std::abort();
+                }
+            }
+        }
+        const uint64_t elapsed_threads = bench::run(1, [&] { partitioner.partition(hashes.data(), rows, threads); });
+
+        const std::string suffix = ", " + std::to_string(partitioner.partitions()) + " partitions";
+        bench::report("naive scatter vs radix_partitioner" + suffix, elapsed_ref, elapsed, rows);
+        report_rows("naive scatter", elapsed_ref, rows);
+        report_rows("radix_partitioner", elapsed, rows);
+        report_rows("radix_partitioner, " + std::to_string(threads) + " threads", elapsed_threads, rows);
+    }
+
+    // End to end, with the batch hashing of the column
+    radix_partitioner partitioner(10);
+    const uint64_t elapsed = bench::run(1, [&] { partitioner.partition(column, threads); });
+    report_rows("column hashing and partitioning, 1024 partitions", elapsed, rows);
+
+    // 64-bit offsets (large_utf8): the same partitions
+    const std::vector<int64_t> large_offsets(offsets.begin(), offsets.end());
+    radix_partitioner large(10);
+    large.partition(large_string_column{ large_offsets.data(), bytes.data(), rows }, threads);
+    for (std::size_t i = 0; i < rows; i++) {
+        const hashed_row& row = large.begin(0)[i];
+        if (row.hash != partitioner.begin(0)[i].hash || row.row != partitioner.begin(0)[i].row) {
+            std::cerr << "large column partition mismatch\n";
+            std::abort();
+        }
+    }
+    return 0;
+}
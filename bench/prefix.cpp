@@ -0,0 +1,143 @@
+/**
+ * Benchmark: longest-prefix match with prefix_matcher, vs. a trie and a linear scan.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../fnv1a_prefix.h"
+#include "bench.h"
+
+// Reference: byte trie with sorted children
+class trie
+{
+public:
+    void insert(const std::string& prefix, std::size_t value)
+    {
+        node* n = &_root;
+        for (const char c : prefix) {
+            auto& child = n->children[uint8_t(c)];
+            if (!child) {
+                child = std::make_unique<node>();
+            }
+            n = child.get();
+        }
+        n->value = value;
+        n->terminal = true;
+    }
+
+    const std::size_t* longest(const std::string& s) const
+    {
+        const node* n = &_root;
+        const std::size_t* best = n->terminal ? &n->value : nullptr;
+        for (const char c : s) {
+            const auto it = n->children.find(uint8_t(c));
+            if (it == n->children.end()) {
+                break;
+            }
+            n = it->second.get();
+            if (n->terminal) {
+                best = &n->value;
+            }
+        }
+        return best;
+    }
+
+private:
+    struct node
+    {
+        std::map<uint8_t, std::unique_ptr<node>> children;
+        std::size_t value = 0;
+        bool terminal = false;
+    };
+    node _root;
+};
+
+// Reference: linear scan
+static const std::size_t* linear(const std::vector<std::pair<std::string, std::size_t>>& prefixes, const std::string& s)
+{
+    const std::pair<std::string, std::size_t>* best = nullptr;
+    for (const auto& p : prefixes) {
+        if (p.first.size() <= s.size() && (best == nullptr || p.first.size() > best->first.size())
+            && s.compare(0, p.first.size(), p.first) == 0) {
+            best = &p;
+        }
+    }
+    return best != nullptr ? &best->second : nullptr;
+}
+
+int main()
+{
+    std::vector<std::string> words;
+#define WORD(W) words.push_back(W)
+#include "../include/words-extract.h"
+#undef WORD
+
+    bench::prng rnd;
+    for (const std::size_t count : { 1000, 100000 }) {
+        // Route-like prefixes: "/word/word/..."
+        std::vector<std::pair<std::string, std::size_t>> prefixes;
+        prefix_matcher<std::size_t> matcher;
+        trie reference;
+        while (prefixes.size() < count) {
+            std::string prefix;
+            for (std::size_t depth = 1 + rnd.below(4); depth != 0; depth--) {
+                prefix += "/" + words[rnd.below(words.size())];
+            }
+            if (matcher.insert(prefix, prefixes.size())) {
+                reference.insert(prefix, prefixes.size());
+                prefixes.emplace_back(prefix, prefixes.size());
+            }
+        }
+
+        // Inputs: registered prefixes with an extra tail, and a few misses
+        std::vector<std::string> inputs;
+        for (std::size_t i = 0; i < 1000; i++) {
+            inputs.push_back(rnd.below(8) == 0 ? "/" + bench::random_string(rnd, 20)
+                                               : prefixes[rnd.below(prefixes.size())].first + "/"
+                                                   + words[rnd.below(words.size())] + "?q=1");
+        }
+
+        // Check
+        for (const auto& input : inputs) {
+            const auto m = matcher.longest(input);
+            const std::size_t* const t = reference.longest(input);
+            const std::size_t* const l = linear(prefixes, input);
+            if ((m.value == nullptr) != (t == nullptr) || (t == nullptr) != (l == nullptr)
+                || (t != nullptr && (*m.value != *t || *t != *l))) {
+                std::cerr << "match mismatch for " << input << "\n";
+                std::abort();
+            }
+        }
+
+        const std::string suffix = ", " + std::to_string(count) + " prefixes";
+        const std::size_t rounds = 100;
+        const uint64_t elapsed_trie = bench::run(rounds, [&] {
+            for (const auto& input : inputs) {
+                bench::keep(reference.longest(input));
+            }
+        });
+        const uint64_t elapsed_linear = bench::run(count > 10000 ? 1 : rounds, [&] {
+            for (const auto& input : inputs) {
+                bench::keep(linear(prefixes, input));
+            }
+        });
+        const uint64_t elapsed = bench::run(rounds, [&] {
+            for (const auto& input : inputs) {
+                bench::keep(matcher.longest(input));
+            }
+        });
+        bench::report("trie vs prefix_matcher" + suffix, elapsed_trie, elapsed, rounds * inputs.size());
+        bench::report("linear scan vs prefix_matcher" + suffix,
+                      elapsed_linear * (count > 10000 ? rounds : 1),
+                      elapsed,
+                      rounds * inputs.size());
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * Benchmark: compile-time reverse table (static_reverse_table::name_of) from fnv1a128 hashes back to the words of
+ * include/words-extract.h, vs. a std::unordered_map<hash, std::string>: memory per key, lookups per second.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../fnv1a_reverse.h"
+#include "bench.h"
+
+// Words of include/words-extract.h, as a constexpr array
+constexpr std::size_t words_count = [] {
+    std::size_t n = 0;
+#define WORD(W) n++
+#include "../include/words-extract.h"
+#undef WORD
+    return n;
+}();
+
+constexpr auto words = [] {
+    std::array<std::string_view, words_count> names{};
+    std::size_t n = 0;
+#define WORD(W) names[n++] = W
+#include "../include/words-extract.h"
+#undef WORD
+    return names;
+}();
+
+// The reverse table, in .rodata
+constexpr auto words_names = make_reverse_table<reverse_table_size(words)>(words);
+
+static_assert(words_names.name_of("existing"_fnv1a128) == "existing", "compile-time lookup");
+static_assert(words_names.name_of("not-a-word"_fnv1a128).empty(), "compile-time miss");
+
+// Allocated bytes (malloc overhead excluded), for the std::unordered_map footprint
+static std::size_t allocated = 0;
+
+template<typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    counting_allocator() = default;
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&)
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        allocated += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        allocated -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const counting_allocator<U>&) const
+    {
+        return true;
+    }
+    template<typename U>
+    bool operator!=(const counting_allocator<U>&) const
+    {
+        return false;
+    }
+};
+
+// std::hash has no 128-bit specialization
+struct hash128
+{
+    std::size_t operator()(fnv1a128::Type h) const { return std::size_t(uint64_t(h) ^ uint64_t(h >> 64)); }
+};
+
+int main()
+{
+    using counted_string = std::basic_string<char, std::char_traits<char>, counting_allocator<char>>;
+    using map_t = std::unordered_map<fnv1a128::Type,
+                                     counted_string,
+                                     hash128,
+                                     std::equal_to<fnv1a128::Type>,
+                                     counting_allocator<std::pair<const fnv1a128::Type, counted_string>>>;
+    auto map = std::make_unique<map_t>();
+    // Words from the table: the words array of string_view is only used at compile time, and has no relocations
+    for (std::size_t i = 0; i < words_names.size(); i++) {
+        const std::string_view word = words_names.names[i];
+        map->emplace(fnv1a128::hash(word), counted_string(word.data(), word.size()));
+    }
+
+    // Lookups: known hashes in random order, then unknown ones
+    const std::size_t count = std::size_t(1) << 22;
+    bench::prng rnd;
+    std::vector<fnv1a128::Type> known(count);
+    std::vector<fnv1a128::Type> unknown(count);
+    for (std::size_t i = 0; i < count; i++) {
+        known[i] = fnv1a128::hash(words_names.names[rnd.below(words_names.size())]);
+        unknown[i] = fnv1a128::hash(bench::random_string(rnd, 4 + rnd.below(8)));
+    }
+    for (std::size_t i = 0; i < count; i++) {
+        const auto it = map->find(known[i]);
+        if (it == map->end() || words_names.name_of(known[i]) != std::string_view(it->second.data(), it->second.size())
+            || words_names.contains(unknown[i]) != (map->find(unknown[i]) != map->end())) {
+            std::cerr << "reverse table mismatch\n";
+            std::abort();
+        }
+    }
+
+    std::cerr << words_count << " words, " << words_names.names.offsets[words_count] << " bytes of names\n";
+    std::cerr << "  static_reverse_table: " << words_names.memory() << " bytes ("
+              << (double(words_names.memory()) / words_count) << " bytes per key), no relocation\n";
+    std::cerr << "  std::unordered_map<hash, std::string>: " << allocated << " bytes ("
+              << (double(allocated) / words_count) << " bytes per key, malloc overhead excluded)\n";
+
+    for (const auto* lookups : { &known, &unknown }) {
+        const char* const kind = lookups == &known ? "known" : "unknown";
+        std::size_t sum = 0;
+        const uint64_t elapsed_map = bench::run(1, [&] {
+            for (const fnv1a128::Type h : *lookups) {
+                const auto it = map->find(h);
+                sum += it != map->end() ? it->second.size() : 0;
+            }
+        });
+        const uint64_t elapsed = bench::run(1, [&] {
+            for (const fnv1a128::Type h : *lookups) {
+                sum += words_names.name_of(h).size();
+            }
+        });
+        bench::keep(sum);
+        bench::report(std::string("name_of, ") + kind + " hashes (std::unordered_map -> static_reverse_table)",
+                      elapsed_map,
+                      elapsed,
+                      count);
+    }
+    return 0;
+}
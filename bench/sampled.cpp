@@ -0,0 +1,89 @@
+/**
+ * Benchmark: sampled hashing (prefix + suffix + length, verified) vs. full hashing, by key length.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../fnv1a_sampled.h"
+#include "bench.h"
+
+int main()
+{
+    bench::prng rnd;
+    for (std::size_t size = 64; size <= 4096; size *= 4) {
+        // URL-like keys sharing a common head
+        std::vector<std::string> keys;
+        for (std::size_t i = 0; i < 1000; i++) {
+            keys.push_back("https://www.example.com/" + bench::random_string(rnd, size - 24));
+        }
+
+        sampled_map<std::size_t> sampled;
+        sampled_map<std::size_t, std::size_t(1) << 30, 0> full; // Samples everything
+        std::unordered_map<std::string, std::size_t> reference;
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            sampled.insert(keys[i], i);
+            full.insert(keys[i], i);
+            reference.emplace(keys[i], i);
+        }
+
+        // Check, including a miss sharing the samples of an existing key
+        for (std::size_t i = 0; i < keys.size(); i++) {
+            std::string other = keys[i];
+            other[size / 2] ^= 1;
+            if (sampled.find(keys[i]) == nullptr || *sampled.find(keys[i]) != i || sampled.find(other) != nullptr
+                || (size > 64 && sampled_map<std::size_t>::hash(other) != sampled_map<std::size_t>::hash(keys[i]))) {
+                std::cerr << "lookup error for " << keys[i] << "\n";
+                std::abort();
+            }
+        }
+
+        const std::size_t rounds = 1 + (1 << 16) / size;
+        const std::size_t ops = rounds * keys.size();
+        const std::string suffix = ", " + std::to_string(size) + "B";
+        {
+            const uint64_t elapsed_ref = bench::run(rounds, [&] {
+                for (const auto& key : keys) {
+                    bench::keep(fnv1a64::hash(key));
+                }
+            });
+            const uint64_t elapsed = bench::run(rounds, [&] {
+                for (const auto& key : keys) {
+                    bench::keep(fnv1a64::hash_sampled(key.data(), key.size()));
+                }
+            });
+            bench::report("hash vs hash_sampled" + suffix, elapsed_ref, elapsed, ops);
+        }
+        {
+            const uint64_t elapsed_ref = bench::run(rounds, [&] {
+                for (const auto& key : keys) {
+                    bench::keep(full.find(key));
+                }
+            });
+            const uint64_t elapsed = bench::run(rounds, [&] {
+                for (const auto& key : keys) {
+                    bench::keep(sampled.find(key));
+                }
+            });
+            bench::report("full-hash table vs sampled_map lookup (verified)" + suffix, elapsed_ref, elapsed, ops);
+        }
+        {
+            const uint64_t elapsed_ref = bench::run(rounds, [&] {
+                for (const auto& key : keys) {
+                    bench::keep(reference.find(key));
+                }
+            });
+            const uint64_t elapsed = bench::run(rounds, [&] {
+                for (const auto& key : keys) {
+                    bench::keep(sampled.find(key));
+                }
+            });
+            bench::report("std::unordered_map vs sampled_map lookup (verified)" + suffix, elapsed_ref, elapsed, ops);
+        }
+    }
+    return 0;
+}
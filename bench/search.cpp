@@ -0,0 +1,170 @@
+/**
+ * Benchmark: multi-keyword substring search (keyword_searcher) throughput on log lines, vs. searching each pattern
+ * separately (the same matches), and vs. tokenizing and dispatching whole tokens (which misses in-word matches).
+ * @comment Usage: bench_search [text-file]; without a file, 2 GB of log lines are generated. Files are mapped, so that
+ * texts larger than memory can be scanned.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../fnv1a_search.h"
+#include "../switch_fnv1a.h"
+#include "bench.h"
+
+// Brute-force reference: every pattern searched independently
+static std::vector<std::pair<std::size_t, std::size_t>> brute_force(const std::vector<std::string>& patterns,
+                                                                    std::string_view text)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> matches;
+    for (std::size_t i = 0; i < patterns.size(); i++) {
+        for (auto pos = text.find(patterns[i]); pos != std::string::npos; pos = text.find(patterns[i], pos + 1)) {
+            matches.emplace_back(pos, i);
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+// Log lines: a timestamp, a level, request fields, and a message of dictionary words, a keyword every ~64 words
+static std::string generate_logs(std::size_t size, const std::vector<std::string>& keywords)
+{
+    static const char* const levels[] = { "INFO", "WARN", "DEBUG", "ERROR" };
+    const std::vector<std::string> words = bench::load_words("words.h");
+    bench::prng rnd;
+    std::string text;
+    text.reserve(size + 4096);
+    char line[256];
+    while (text.size() < size) {
+        const int n = std::snprintf(line,
+                                    sizeof(line),
+                                    "2026-10-17T%02u:%02u:%02u.%03uZ %s [worker-%u] request_id=%016llx "
+                                    "path=/api/v1/items/%u status=%u latency_ms=%u msg=\"",
+                                    unsigned(rnd.below(24)),
+                                    unsigned(rnd.below(60)),
+                                    unsigned(rnd.below(60)),
+                                    unsigned(rnd.below(1000)),
+                                    levels[rnd.below(4)],
+                                    unsigned(rnd.below(64)),
+                                    static_cast<unsigned long long>(rnd()),
+                                    unsigned(rnd.below(100000)),
+                                    rnd.below(8) == 0 ? 404u : 200u,
+                                    unsigned(rnd.below(1000)));
+        text.append(line, std::size_t(n));
+        for (std::size_t i = 3 + rnd.below(6); i != 0; i--) {
+            text += rnd.below(64) == 0 ? keywords[rnd.below(keywords.size())] : words[rnd.below(words.size())];
+            text += i != 1 ? ' ' : '"';
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+int main(int argc, char** argv)
+{
+    const std::vector<std::string> patterns = bench::load_words("words-extract.h");
+    keyword_searcher searcher;
+    for (const auto& pattern : patterns) {
+        searcher.add(pattern);
+    }
+    searcher.build();
+
+    // Text
+    std::string generated;
+    std::string_view text;
+    if (argc > 1) {
+        const int fd = open(argv[1], O_RDONLY);
+        struct stat st;
+        if (fd == -1 || fstat(fd, &st) != 0 || st.st_size == 0) {
+            std::cerr << "could not open " << argv[1] << "\n";
+            return EXIT_FAILURE;
+        }
+        void* const data = mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            std::cerr << "could not map " << argv[1] << "\n";
+            return EXIT_FAILURE;
+        }
+        madvise(data, std::size_t(st.st_size), MADV_SEQUENTIAL);
+        text = std::string_view(static_cast<const char*>(data), std::size_t(st.st_size));
+    } else {
+        generated = generate_logs(std::size_t(2) << 30, patterns);
+        text = generated;
+    }
+    std::cerr << "text: " << (text.size() >> 20) << "MB, " << patterns.size() << " patterns\n";
+
+    // Check on the first megabyte
+    {
+        const std::string_view head = text.substr(0, 1 << 20);
+        std::vector<std::pair<std::size_t, std::size_t>> matches;
+        searcher.search(head.data(), head.size(), [&](std::size_t index, std::size_t offset) {
+            matches.emplace_back(offset, index);
+        });
+        std::sort(matches.begin(), matches.end());
+        if (matches != brute_force(patterns, head)) {
+            std::cerr << "search mismatch\n";
+            std::abort();
+        }
+    }
+
+    // Substring search
+    std::size_t found = 0;
+    const uint64_t elapsed = bench::run(1, [&] {
+        searcher.search(text.data(), text.size(), [&](std::size_t, std::size_t) { found++; });
+    });
+
+    // Each pattern searched separately, on the first 16 MB (same matches, one pass per pattern)
+    const std::string_view slice = text.substr(0, 16 << 20);
+    std::size_t found_slice = 0;
+    const uint64_t elapsed_slice = bench::run(1, [&] {
+        searcher.search(slice.data(), slice.size(), [&](std::size_t, std::size_t) { found_slice++; });
+    });
+    std::size_t found_each = 0;
+    const uint64_t elapsed_each = bench::run(1, [&] {
+        for (const auto& pattern : patterns) {
+            for (auto pos = slice.find(pattern); pos != std::string::npos; pos = slice.find(pattern, pos + 1)) {
+                found_each++;
+            }
+        }
+    });
+    if (found_each != found_slice) {
+        std::cerr << "search mismatch\n";
+        std::abort();
+    }
+
+    // Whole-token dispatch, for reference
+    std::unordered_set<uint64_t> hashes;
+    for (const auto& pattern : patterns) {
+        hashes.insert(fnv1a64::hash(pattern));
+    }
+    std::size_t found_tokens = 0;
+    const uint64_t elapsed_tokens = bench::run(1, [&] {
+        for (std::size_t pos = 0; pos < text.size();) {
+            std::size_t len = text.size() - pos;
+            const auto h = fnv1a64::hash_until<stop_space>(text.data() + pos, text.size() - pos, &len);
+            found_tokens += hashes.count(h);
+            pos += len;
+        }
+    });
+
+    std::cerr << "keyword_searcher: " << double(text.size()) / elapsed << "GB/s, " << found << " matches\n";
+    bench::report("find per pattern vs keyword_searcher, per byte of the first 16MB",
+                  elapsed_each,
+                  elapsed_slice,
+                  slice.size());
+    std::cerr << "tokenize+dispatch: " << double(text.size()) / elapsed_tokens << "GB/s, " << found_tokens
+              << " whole-token matches (in-word matches are missed)\n";
+    return 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * Benchmark: shard routing with jump_shard and rendezvous_router over fnv1a64 hashes (keys/s, balance, and keys moved
+ * when a node is added), vs. std::hash followed by a modulo, from 10 to 10k nodes.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../fnv1a_shard.h"
+#include "bench.h"
+
+// Routing statistics
+struct routing
+{
+    double keys_per_second; // Millions
+    double max_load;        // Largest node load / mean load
+    double moved;           // Keys moved when one node is added (ratio)
+};
+
+/**
+ * Measure a routing function
+ * @param route Function routing all keys to n nodes, route(n, out)
+ * @param nodes The number of nodes
+ * @param keys The number of keys
+ */
+template<typename F>
+static routing measure(F&& route, std::size_t nodes, std::size_t keys)
+{
+    std::vector<uint32_t> before(keys);
+    std::vector<uint32_t> after(keys);
+    const uint64_t elapsed = bench::run(1, [&] { route(nodes, before.data()); });
+    route(nodes + 1, after.data());
+
+    std::vector<std::size_t> loads(nodes, 0);
+    std::size_t moved = 0;
+    for (std::size_t i = 0; i < keys; i++) {
+        loads[before[i]]++;
+        moved += before[i] != after[i];
+    }
+    const double mean = double(keys) / double(nodes);
+    return routing{ double(keys) * 1000 / double(elapsed),
+                    double(*std::max_element(loads.begin(), loads.end())) / mean,
+                    double(moved) / double(keys) };
+}
+
+static void report(const std::string& name, const routing& r)
+{
+    std::cerr << "  " << name << ": " << r.keys_per_second << "M keys/s, max load " << r.max_load << "x the mean, "
+              << (100 * r.moved) << "% keys moved\n";
+}
+
+int main()
+{
+    const std::size_t keys = std::size_t(1) << 20;
+    std::vector<std::size_t> std_hashes(keys);
+    std::vector<fnv1a64::Type> hashes(keys);
+    for (std::size_t i = 0; i < keys; i++) {
+        const std::string key = "key:" + std::to_string(i);
+        std_hashes[i] = std::hash<std::string_view>()(key);
+        hashes[i] = fnv1a64::hash(key);
+    }
+
+    for (const std::size_t nodes : { 10, 100, 1000, 10000 }) {
+        // Rendezvous hashing is O(nodes) per key: fewer keys for many nodes
+        const std::size_t rendezvous_keys = std::min(keys, std::max<std::size_t>(65536, (keys << 7) / nodes));
+        // Largest of n binomial loads: about sqrt(2 ln n) standard deviations above the mean
+        std::cerr << nodes << " nodes (" << keys << " keys: max load expected around "
+                  << (1 + std::sqrt(2 * std::log(double(nodes)) * double(nodes) / double(keys))) << "x the mean, "
+                  << (100.0 / double(nodes + 1)) << "% keys moved)\n";
+
+        report("std::hash % nodes", measure([&](std::size_t n, uint32_t* out) {
+                   for (std::size_t i = 0; i < keys; i++) {
+                       out[i] = uint32_t(std_hashes[i] % n);
+                   }
+               },
+                                            nodes,
+                                            keys));
+        report("jump_shard", measure([&](std::size_t n, uint32_t* out) {
+                   for (std::size_t i = 0; i < keys; i++) {
+                       out[i] = jump_shard(hashes[i], uint32_t(n));
+                   }
+               },
+                                     nodes,
+                                     keys));
+        report("jump_shard, batch",
+               measure([&](std::size_t n, uint32_t* out) { jump_shard(hashes.data(), keys, uint32_t(n), out); },
+                       nodes,
+                       keys));
+
+        rendezvous_router router;
+        for (std::size_t node = 0; node <= nodes; node++) {
+            router.add("node-" + std::to_string(node));
+        }
+        // Routing to the first n nodes: a zero weight removes the last one
+        const auto rendezvous = [&](bool batch) {
+            return [&router, batch, nodes, rendezvous_keys, &hashes](std::size_t n, uint32_t* out) {
+                router.set_weight(nodes, n > nodes ? 1 : 0);
+                if (batch) {
+                    router.route(hashes.data(), rendezvous_keys, out);
+                } else {
+                    for (std::size_t i = 0; i < rendezvous_keys; i++) {
+                        out[i] = uint32_t(router.route(hashes[i]));
+                    }
+                }
+            };
+        };
+        const std::string suffix = ", " + std::to_string(rendezvous_keys) + " keys";
+        report("rendezvous_router, weighted" + suffix, measure(rendezvous(false), nodes, rendezvous_keys));
+        report("rendezvous_router, weighted batch" + suffix, measure(rendezvous(true), nodes, rendezvous_keys));
+
+        // Same routes without weights: all nodes, or all but the last one
+        rendezvous_router uniform;
+        for (std::size_t node = 0; node < nodes; node++) {
+            uniform.add("node-" + std::to_string(node));
+        }
+        rendezvous_router grown = uniform;
+        grown.add("node-" + std::to_string(nodes));
+        report("rendezvous_router, unweighted batch" + suffix, measure([&](std::size_t n, uint32_t* out) {
+                   (n > nodes ? grown : uniform).route(hashes.data(), rendezvous_keys, out);
+               },
+                                                                       nodes,
+                                                                       rendezvous_keys));
+    }
+
+    // Batch routes are the scalar ones
+    std::vector<uint32_t> routes(keys);
+    jump_shard(hashes.data(), keys, 1000, routes.data());
+    for (std::size_t i = 0; i < keys; i++) {
+        if (routes[i] != jump_shard(hashes[i], 1000)) {
+            std::cerr << "jump_shard batch mismatch\n";
+            std::abort();
+        }
+    }
+
+    // Weighted shares: node i has weight i + 1
+    rendezvous_router weighted;
+    double total = 0;
+    for (std::size_t node = 0; node < 10; node++) {
+        weighted.add("node-" + std::to_string(node), double(node + 1));
+        total += double(node + 1);
+    }
+    weighted.route(hashes.data(), keys, routes.data());
+    std::vector<std::size_t> loads(10, 0);
+    for (std::size_t i = 0; i < keys; i++) {
+        if (routes[i] != weighted.route(hashes[i])) {
+            std::cerr << "rendezvous_router batch mismatch\n";
+            std::abort();
+        }
+        loads[routes[i]]++;
+    }
+    double error = 0;
+    for (std::size_t node = 0; node < 10; node++) {
+        const double expected = double(keys) * double(node + 1) / total;
+        error = std::max(error, std::fabs(double(loads[node]) / expected - 1));
+    }
+    std::cerr << "weighted rendezvous_router, weights 1 to 10: " << (100 * error) << "% max share error\n";
+
+    // String keys, hashed on the fly: the routes of their hashes
+    std::vector<std::string> names(65536);
+    for (std::size_t i = 0; i < names.size(); i++) {
+        names[i] = "key:" + std::to_string(i);
+    }
+    std::size_t sum = 0;
+    const uint64_t elapsed = bench::run(1, [&] {
+        for (const std::string& name : names) {
+            sum += weighted.route(name) + jump_shard(name, 1000);
+        }
+    });
+    for (std::size_t i = 0; i < names.size(); i++) {
+        if (weighted.route(names[i]) != routes[i] || jump_shard(names[i], 1000) != jump_shard(hashes[i], 1000)) {
+            std::cerr << "std::string key mismatch\n";
+            std::abort();
+        }
+    }
+    std::cerr << "std::string keys, weighted rendezvous_router and jump_shard: "
+              << double(names.size()) * 1000 / double(elapsed) << "M keys/s (" << sum << ")\n";
+    return 0;
+}
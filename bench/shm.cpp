@@ -0,0 +1,133 @@
+/**
+ * Benchmark: string interning by several processes with a shared shm_intern_table, vs. a private
+ * std::unordered_map<std::string, uint32_t> per process.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../fnv1a_shm.h"
+#include "bench.h"
+
+// Per-process results, in a shared anonymous mapping
+struct result
+{
+    uint64_t insert;   // Elapsed, in nanoseconds
+    uint64_t lookup;   // Elapsed, in nanoseconds
+    uint64_t checksum; // Of the IDs, in key order
+};
+
+// Run fun(p) in each of 'processes' child processes, and wait for them
+template<typename F>
+static void run_processes(unsigned processes, F&& fun)
+{
+    for (unsigned p = 0; p < processes; p++) {
+        if (fork() == 0) {
+            fun(p);
+            _exit(0);
+        }
+    }
+    for (unsigned p = 0; p < processes; p++) {
+        int status;
+        if (wait(&status) == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cerr << "child process failed\n";
+            std::abort();
+        }
+    }
+}
+
+int main()
+{
+    // Labels: words.h values with a numeric suffix
+    const std::vector<std::string> words = bench::load_words("words.h");
+    const std::size_t count = std::size_t(1) << 20;
+    std::vector<std::string> keys;
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        keys.push_back(words[i % words.size()] + ":" + std::to_string(i / words.size()));
+        bytes += keys.back().size();
+    }
+
+    result* const results = static_cast<result*>(
+      mmap(nullptr, 64 * sizeof(result), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+    for (const unsigned processes : { 1, 2, 4 }) {
+        std::cerr << processes << " processes, " << count << " labels each\n";
+
+        // Each process starts at a different key, so that inserts race
+        shm_intern_table table = shm_intern_table::create("", count, bytes);
+        if (!table.valid()) {
+            std::cerr << "could not create the segment\n";
+            return 1;
+        }
+        run_processes(processes, [&](unsigned p) {
+            const std::size_t start = count * p / processes;
+            std::vector<uint32_t> ids(count);
+            results[p].insert = bench::run(1, [&] {
+                for (std::size_t i = 0; i < count; i++) {
+                    const std::size_t k = (start + i) % count;
+                    ids[k] = table.intern(keys[k]);
+                }
+            });
+            uint64_t checksum = 0;
+            results[p].lookup = bench::run(1, [&] {
+                for (std::size_t k = 0; k < count; k++) {
+                    const uint32_t id = table.find(keys[k]);
+                    if (id != ids[k] || table.name(id) != keys[k]) {
+                        _exit(1);
+                    }
+                    checksum = checksum * 0x100000001b3 + id;
+                }
+            });
+            results[p].checksum = checksum;
+        });
+        uint64_t insert = 0;
+        uint64_t lookup = 0;
+        for (unsigned p = 0; p < processes; p++) {
+            if (results[p].checksum != results[0].checksum) {
+                std::cerr << "ID mismatch between processes\n";
+                return 1;
+            }
+            insert = std::max(insert, results[p].insert);
+            lookup = std::max(lookup, results[p].lookup);
+        }
+        std::cerr << "  shm_intern_table: " << (double(processes * count) * 1000 / insert) << "M inserts/s, "
+                  << (double(processes * count) * 1000 / lookup) << "M lookups/s (all processes), "
+                  << table.size() - count << " IDs lost to races, " << (table.arena_used() >> 20)
+                  << "MB of strings shared\n";
+
+        run_processes(processes, [&](unsigned p) {
+            std::unordered_map<std::string, uint32_t> map;
+            results[p].insert = bench::run(1, [&] {
+                for (std::size_t k = 0; k < count; k++) {
+                    map.emplace(keys[k], uint32_t(map.size()));
+                }
+            });
+            uint64_t checksum = 0;
+            results[p].lookup = bench::run(1, [&] {
+                for (std::size_t k = 0; k < count; k++) {
+                    checksum = checksum * 0x100000001b3 + map.find(keys[k])->second;
+                }
+            });
+            results[p].checksum = checksum;
+        });
+        insert = 0;
+        lookup = 0;
+        for (unsigned p = 0; p < processes; p++) {
+            insert = std::max(insert, results[p].insert);
+            lookup = std::max(lookup, results[p].lookup);
+        }
+        std::cerr << "  std::unordered_map per process: " << (double(processes * count) * 1000 / insert)
+                  << "M inserts/s, " << (double(processes * count) * 1000 / lookup) << "M lookups/s (all processes), "
+                  << processes << " private copies\n";
+    }
+    return 0;
+}
@@ -0,0 +1,191 @@
+/**
+ * Benchmark: hyperloglog, count_min_sketch and space_saving over fnv1a128 hashes of a Zipf-distributed stream of
+ * words.h values (updates per second and accuracy), vs. exact counting with std::unordered_map.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../fnv1a_sketch.h"
+#include "bench.h"
+
+static void report_updates(const std::string& name, uint64_t elapsed, std::size_t updates)
+{
+    std::cerr << "  " << name << ": " << (double(updates) * 1000 / elapsed) << "M updates/s\n";
+}
+
+// Run fun(t, first, last) on each of the chunks of a stream, one thread per chunk
+template<typename F>
+static void parallel(unsigned threads, std::size_t rows, F&& fun)
+{
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&fun, t, threads, rows] { fun(t, rows * t / threads, rows * (t + 1) / threads); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int main()
+{
+    const std::vector<std::string> words = bench::load_words("words.h");
+    const unsigned threads = std::max(4u, std::thread::hardware_concurrency());
+
+    // Zipf (s = 1) over the words, drawn in list order of rank
+    std::vector<double> cdf(words.size());
+    double total = 0;
+    for (std::size_t i = 0; i < words.size(); i++) {
+        total += 1.0 / double(i + 1);
+        cdf[i] = total;
+    }
+    const std::size_t rows = std::size_t(1) << 24;
+    bench::prng rnd;
+    std::vector<std::string_view> stream(rows);
+    std::vector<fnv1a128::Type> hashes(rows);
+    for (std::size_t i = 0; i < rows; i++) {
+        const double u = double(rnd() >> 11) / double(uint64_t(1) << 53) * total;
+        const std::size_t rank = std::min<std::size_t>(std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin(),
+                                                        words.size() - 1);
+        stream[i] = words[rank];
+        hashes[i] = fnv1a128::hash(words[rank]);
+    }
+
+    // Exact counts
+    std::unordered_map<std::string_view, uint64_t> exact;
+    const uint64_t elapsed_exact = bench::run(1, [&] {
+        for (const std::string_view word : stream) {
+            exact[word]++;
+        }
+    });
+    std::vector<std::pair<std::string_view, uint64_t>> ranked(exact.begin(), exact.end());
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    std::cerr << rows << " rows, " << exact.size() << " distinct values\n";
+    report_updates("std::unordered_map<std::string_view, uint64_t>", elapsed_exact, rows);
+
+    // Cardinality
+    hyperloglog<14> hll;
+    const uint64_t elapsed_hll = bench::run(1, [&] {
+        for (const auto& hash : hashes) {
+            hll.add(hash);
+        }
+    });
+    std::vector<hyperloglog<14>> hll_threads(threads);
+    const uint64_t elapsed_hll_parallel = bench::run(1, [&] {
+        parallel(threads, rows, [&](unsigned t, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; i++) {
+                hll_threads[t].add(hashes[i]);
+            }
+        });
+        for (unsigned t = 1; t < threads; t++) {
+            hll_threads[0].merge(hll_threads[t]);
+        }
+    });
+    if (hll.estimate() != hll_threads[0].estimate()) {
+        std::cerr << "hyperloglog mismatch\n";
+        std::abort();
+    }
+    std::cerr << "hyperloglog<14>, " << hll.memory() << " bytes: " << hll.estimate() << " distinct values estimated\n";
+    report_updates("scalar", elapsed_hll, rows);
+    report_updates(std::to_string(threads) + " threads, merged", elapsed_hll_parallel, rows);
+
+    // Cardinality accuracy over distinct keys, fnv1a64
+    for (const std::size_t distinct : { 100, 10000, 1000000, 10000000 }) {
+        hyperloglog<14> sketch;
+        for (std::size_t i = 0; i < distinct; i++) {
+            sketch.add(fnv1a64::hash("user:" + std::to_string(i)));
+        }
+        std::cerr << "  " << distinct << " distinct fnv1a64 keys: "
+                  << (100 * (sketch.estimate() - double(distinct)) / double(distinct)) << "% error\n";
+    }
+
+    // Frequencies
+    count_min_sketch<> cms;
+    const uint64_t elapsed_cms = bench::run(1, [&] {
+        for (const auto& hash : hashes) {
+            cms.add(hash);
+        }
+    });
+    std::vector<count_min_sketch<>> cms_threads(threads);
+    const uint64_t elapsed_cms_parallel = bench::run(1, [&] {
+        parallel(threads, rows, [&](unsigned t, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; i++) {
+                cms_threads[t].add(hashes[i]);
+            }
+        });
+        for (unsigned t = 1; t < threads; t++) {
+            cms_threads[0].merge(cms_threads[t]);
+        }
+    });
+    double top_error = 0;
+    double mean_overestimate = 0;
+    for (std::size_t i = 0; i < ranked.size(); i++) {
+        const auto hash = fnv1a128::hash(ranked[i].first);
+        const uint64_t estimate = cms.estimate(hash);
+        if (estimate < ranked[i].second || estimate != cms_threads[0].estimate(hash)) {
+            std::cerr << "count_min_sketch mismatch\n";
+            std::abort();
+        }
+        if (i < 100) {
+            top_error += double(estimate - ranked[i].second) / double(ranked[i].second) / 100;
+        }
+        mean_overestimate += double(estimate - ranked[i].second) / double(ranked.size());
+    }
+    std::cerr << "count_min_sketch, " << cms.memory() << " bytes: " << (100 * top_error)
+              << "% mean error on the top 100 values, " << mean_overestimate << " mean overestimate\n";
+    report_updates("scalar", elapsed_cms, rows);
+    report_updates(std::to_string(threads) + " threads, merged", elapsed_cms_parallel, rows);
+
+    // Heavy hitters
+    const auto recall = [&](const space_saving& tracker) {
+        std::unordered_set<std::string_view> found;
+        for (const auto& item : tracker.top(100)) {
+            found.insert(item.key);
+        }
+        std::size_t hits = 0;
+        for (std::size_t i = 0; i < 100; i++) {
+            hits += found.count(ranked[i].first);
+        }
+        return hits;
+    };
+    space_saving tracker(1024);
+    const uint64_t elapsed_ss = bench::run(1, [&] {
+        for (std::size_t i = 0; i < rows; i++) {
+            tracker.add(stream[i], hashes[i]);
+        }
+    });
+    std::vector<space_saving> trackers(threads, space_saving(1024));
+    const uint64_t elapsed_ss_parallel = bench::run(1, [&] {
+        parallel(threads, rows, [&](unsigned t, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; i++) {
+                trackers[t].add(stream[i], hashes[i]);
+            }
+        });
+        for (unsigned t = 1; t < threads; t++) {
+            trackers[0].merge(trackers[t]);
+        }
+    });
+    for (const space_saving* t : { &tracker, &trackers[0] }) {
+        for (const auto& item : t->top(1024)) {
+            const uint64_t count = exact[item.key];
+            if (count > item.count || count < item.count - item.error) {
+                std::cerr << "space_saving bounds mismatch\n";
+                std::abort();
+            }
+        }
+    }
+    std::cerr << "space_saving(1024): " << recall(tracker) << "/100 top values found, " << recall(trackers[0])
+              << "/100 once merged\n";
+    report_updates("scalar", elapsed_ss, rows);
+    report_updates(std::to_string(threads) + " threads, merged", elapsed_ss_parallel, rows);
+    return 0;
+}
@@ -0,0 +1,97 @@
+/**
+ * Benchmark: load time (dlopen + first lookup + dlclose) of a shared library holding the 63k keywords of
+ * include/words.h as a table of pointers, vs. as a relocation-free static_string_pool (see startup_keywords.cpp).
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <dlfcn.h>
+#include <link.h>
+
+#include "bench.h"
+
+// Dynamic relocations of a loaded module, from its DT_RELA/DT_REL entries
+static std::size_t relocations(void* module)
+{
+    struct link_map* map = nullptr;
+    if (dlinfo(module, RTLD_DI_LINKMAP, &map) != 0) {
+        return 0;
+    }
+    std::size_t rela = 0, rela_entry = sizeof(ElfW(Rela)), rel = 0, rel_entry = sizeof(ElfW(Rel)), plt = 0;
+    for (const ElfW(Dyn)* d = map->l_ld; d->d_tag != DT_NULL; d++) {
+        switch (d->d_tag) {
+        case DT_RELASZ:
+            rela = d->d_un.d_val;
+            break;
+        case DT_RELAENT:
+            rela_entry = d->d_un.d_val;
+            break;
+        case DT_RELSZ:
+            rel = d->d_un.d_val;
+            break;
+        case DT_RELENT:
+            rel_entry = d->d_un.d_val;
+            break;
+        case DT_PLTRELSZ:
+            plt = d->d_un.d_val;
+            break;
+        }
+    }
+    return rela / rela_entry + rel / rel_entry + plt / rela_entry;
+}
+
+using keyword_fn = std::size_t (*)(std::size_t, const char**);
+using keyword_count_fn = std::size_t (*)();
+
+int main()
+{
+    const std::size_t rounds = 200;
+    std::string reference;
+    for (const char* const mode : { "pointers", "offsets" }) {
+        const std::string path = std::string(STARTUP_MODULES_DIR) + "/libstartup_" + mode + ".so";
+
+        // First load: check the module, and that dlclose() unloads it (otherwise the next loads are free)
+        void* module = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (module == nullptr) {
+            std::cerr << dlerror() << "\n";
+            return EXIT_FAILURE;
+        }
+        const auto keyword = reinterpret_cast<keyword_fn>(dlsym(module, "keyword"));
+        const auto keyword_count = reinterpret_cast<keyword_count_fn>(dlsym(module, "keyword_count"));
+        const std::size_t count = keyword_count();
+        std::string keywords;
+        for (std::size_t i = 0; i < count; i++) {
+            const char* data;
+            const std::size_t size = keyword(i, &data);
+            keywords.append(data, size).append(1, '\n');
+        }
+        if (reference.empty()) {
+            reference = keywords;
+        } else if (keywords != reference) {
+            std::cerr << "keyword mismatch\n";
+            std::abort();
+        }
+        const std::size_t relocs = relocations(module);
+        dlclose(module);
+        if (dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL | RTLD_NOLOAD) != nullptr) {
+            std::cerr << "libstartup_" << mode << ".so is not unloaded by dlclose\n";
+            std::abort();
+        }
+
+        std::size_t sum = 0;
+        const uint64_t elapsed = bench::run(rounds, [&] {
+            void* const m = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+            const char* data;
+            sum += reinterpret_cast<keyword_fn>(dlsym(m, "keyword"))(count / 2, &data);
+            dlclose(m);
+        });
+        bench::keep(sum);
+        std::cerr << "  " << mode << ": " << count << " keywords, " << relocs << " dynamic relocations, "
+                  << (double(elapsed) / rounds / 1000) << "us per load\n";
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+/**
+ * Benchmark module: the keywords of include/words.h, as a table of pointers (STARTUP_OFFSETS=0, one dynamic relocation
+ * per keyword) or as a static_string_pool (STARTUP_OFFSETS=1, none). Loaded by bench_startup.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+#include "../fnv1a_pool.h"
+
+constexpr std::size_t keywords_count = [] {
+    std::size_t n = 0;
+#define WORD(W) n++
+#include "../include/words.h"
+#undef WORD
+    return n;
+}();
+
+#if STARTUP_OFFSETS
+
+constexpr auto keywords_strings = [] {
+    std::array<std::string_view, keywords_count> strings{};
+    std::size_t n = 0;
+#define WORD(W) strings[n++] = W
+#include "../include/words.h"
+#undef WORD
+    return strings;
+}();
+constexpr auto keywords = make_string_pool<string_pool_size(keywords_strings)>(keywords_strings);
+
+extern "C" std::size_t keyword(std::size_t index, const char** data)
+{
+    const std::string_view s = keywords[index];
+    *data = s.data();
+    return s.size();
+}
+
+#else
+
+constexpr auto keywords = [] {
+    std::array<const char*, keywords_count> strings{};
+    std::size_t n = 0;
+#define WORD(W) strings[n++] = W
+#include "../include/words.h"
+#undef WORD
+    return strings;
+}();
+
+extern "C" std::size_t keyword(std::size_t index, const char** data)
+{
+    *data = keywords[index];
+    return std::string_view(keywords[index]).size();
+}
+
+#endif
+
+extern "C" std::size_t keyword_count()
+{
+    return keywords_count;
+}
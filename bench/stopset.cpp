@@ -0,0 +1,70 @@
+/**
+ * Benchmark: hashing tokens up to a multi-delimiter stop set, vs. a delimiter scan followed by the hash.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../switch_fnv1a.h"
+#include "bench.h"
+
+// Two-pass reference: find the delimiter, then hash
+template<typename Stop>
+static fnv1a128::Type two_pass(const char* s, std::size_t l, std::size_t* stopLen)
+{
+    std::size_t j = 0;
+    while (j < l && !Stop::contains(s[j])) {
+        j++;
+    }
+    if (j < l) {
+        *stopLen = j + 1;
+    }
+    return fnv1a128::hash(s, j);
+}
+
+int main()
+{
+    bench::prng rnd;
+    for (std::size_t size = 4; size <= 256; size *= 4) {
+        // "key=value" lines, with keys of about 'size' bytes
+        std::vector<std::string> lines;
+        for (std::size_t i = 0; i < 64; i++) {
+            lines.push_back(bench::random_string(rnd, size + rnd.below(size)) + "=" + bench::random_string(rnd, 16));
+        }
+
+        // Check
+        for (const auto& line : lines) {
+            std::size_t len1 = 0, len2 = 0;
+            if (fnv1a128::hash_until<stop_token>(line.c_str(), line.size(), &len1)
+                    != two_pass<stop_token>(line.c_str(), line.size(), &len2)
+                || len1 != len2) {
+                std::cerr << "hash mismatch for " << line << "\n";
+                std::abort();
+            }
+        }
+
+        const std::size_t rounds = 1 + (1 << 18) / size;
+        const uint64_t elapsed_ref = bench::run(rounds, [&] {
+            for (const auto& line : lines) {
+                std::size_t len = 0;
+                bench::keep(two_pass<stop_token>(line.c_str(), line.size(), &len));
+                bench::keep(len);
+            }
+        });
+        const uint64_t elapsed = bench::run(rounds, [&] {
+            for (const auto& line : lines) {
+                std::size_t len = 0;
+                bench::keep(fnv1a128::hash_until<stop_token>(line.c_str(), line.size(), &len));
+                bench::keep(len);
+            }
+        });
+        bench::report("scan+hash vs hash_until<stop_token>, ~" + std::to_string(size + size / 2) + "B keys",
+                      elapsed_ref,
+                      elapsed,
+                      rounds * lines.size());
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * Benchmark: file extension dispatch with a backward hash (fnv1a::hash_reverse), vs. a search for the last '.'
+ * followed by a forward hash.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../switch_fnv1a.h"
+#include "bench.h"
+
+static const char* const extensions[] = { ".jpg", ".png", ".gif",  ".html",   ".css",
+                                           ".js",  ".json", ".txt", ".tar.gz", ".c" };
+
+// Forward version: find the last '.', then hash
+static int dispatch_forward(const std::string& path)
+{
+    const auto dot = path.rfind('.');
+    if (dot == std::string::npos) {
+        return -1;
+    }
+    switch (fnv1a64::hash(path.data() + dot, path.size() - dot)) {
+    case ".jpg"_fnv1a64:
+        return 0;
+    case ".png"_fnv1a64:
+        return 1;
+    case ".gif"_fnv1a64:
+        return 2;
+    case ".html"_fnv1a64:
+        return 3;
+    case ".css"_fnv1a64:
+        return 4;
+    case ".js"_fnv1a64:
+        return 5;
+    case ".json"_fnv1a64:
+        return 6;
+    case ".txt"_fnv1a64:
+        return 7;
+    case ".gz"_fnv1a64:
+        return 8;
+    case ".c"_fnv1a64:
+        return 9;
+    default:
+        return -1;
+    }
+}
+
+// Backward version: a single pass from the end
+static int dispatch_reverse(const std::string& path)
+{
+    std::size_t consumed = 0;
+    switch (fnv1a64::hash_reverse<'.'>(path.data(), path.size(), &consumed)) {
+    case ".jpg"_fnv1a64_rev:
+        return 0;
+    case ".png"_fnv1a64_rev:
+        return 1;
+    case ".gif"_fnv1a64_rev:
+        return 2;
+    case ".html"_fnv1a64_rev:
+        return 3;
+    case ".css"_fnv1a64_rev:
+        return 4;
+    case ".js"_fnv1a64_rev:
+        return 5;
+    case ".json"_fnv1a64_rev:
+        return 6;
+    case ".txt"_fnv1a64_rev:
+        return 7;
+    case ".gz"_fnv1a64_rev:
+        return 8;
+    case ".c"_fnv1a64_rev:
+        return 9;
+    default:
+        return -1;
+    }
+}
+
+int main()
+{
+    // Synthetic paths: a few directories, a file name, an extension (or none)
+    bench::prng rnd;
+    std::vector<std::string> paths;
+    for (std::size_t i = 0; i < 4096; i++) {
+        std::string path;
+        for (std::size_t depth = rnd.below(6); depth != 0; depth--) {
+            path += "/" + bench::random_string(rnd, 3 + rnd.below(12));
+        }
+        path += "/" + bench::random_string(rnd, 4 + rnd.below(16));
+        const std::size_t ext = rnd.below(std::size(extensions) + 2);
+        if (ext < std::size(extensions)) {
+            path += extensions[ext];
+        } else if (ext == std::size(extensions)) {
+            path += ".unknown";
+        }
+        paths.push_back(path);
+    }
+
+    // Check
+    for (const auto& path : paths) {
+        if (dispatch_forward(path) != dispatch_reverse(path)) {
+            std::cerr << "dispatch mismatch for " << path << "\n";
+            std::abort();
+        }
+    }
+
+    const std::size_t rounds = 1000;
+    const uint64_t elapsed_ref = bench::run(rounds, [&] {
+        for (const auto& path : paths) {
+            bench::keep(dispatch_forward(path));
+        }
+    });
+    const uint64_t elapsed = bench::run(rounds, [&] {
+        for (const auto& path : paths) {
+            bench::keep(dispatch_reverse(path));
+        }
+    });
+    bench::report("rfind+hash vs hash_reverse, extension dispatch", elapsed_ref, elapsed, rounds * paths.size());
+    return 0;
+}
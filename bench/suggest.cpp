@@ -0,0 +1,87 @@
+/**
+ * Benchmark: "did you mean" suggestions with keyword_suggester, vs. a brute-force edit distance over all keywords.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../fnv1a_suggest.h"
+#include "bench.h"
+
+// Brute-force reference: the closest keyword (lowest index on ties)
+static suggestion brute_force(const std::vector<std::string>& words, const std::string& query)
+{
+    suggestion best = { 0, suggest_detail::max_distance + 1 };
+    for (std::size_t i = 0; i < words.size(); i++) {
+        const std::size_t d = suggest_detail::distance(query, words[i], suggest_detail::max_distance);
+        if (d < best.distance) {
+            best = suggestion{ i, d };
+        }
+    }
+    return best;
+}
+
+int main()
+{
+    const std::vector<std::string> words = bench::load_words("words.h");
+
+    std::unique_ptr<keyword_suggester> suggester;
+    const uint64_t elapsed_build = bench::run(1, [&] { suggester = std::make_unique<keyword_suggester>(words); });
+    std::cerr << "index: " << words.size() << " keywords, built in " << (elapsed_build / 1000000) << "ms, "
+              << (suggester->memory() >> 20) << "MB\n";
+
+    // Queries: keywords with one or two random edits
+    bench::prng rnd;
+    std::vector<std::string> queries;
+    for (std::size_t i = 0; i < 200; i++) {
+        std::string query = words[rnd.below(words.size())];
+        for (std::size_t edits = 1 + rnd.below(2); edits != 0; edits--) {
+            const std::size_t at = rnd.below(query.size() + 1);
+            switch (rnd.below(3)) {
+            case 0:
+                query.insert(at, 1, 'a' + rnd.below(26));
+                break;
+            case 1:
+                if (at < query.size()) {
+                    query.erase(at, 1);
+                }
+                break;
+            default:
+                if (at < query.size()) {
+                    query[at] = 'a' + rnd.below(26);
+                }
+                break;
+            }
+        }
+        queries.push_back(query);
+    }
+
+    // Check
+    for (const auto& query : queries) {
+        const auto expected = brute_force(words, query);
+        const auto found = suggester->suggest(query);
+        if ((expected.distance > suggest_detail::max_distance) != found.empty()
+            || (!found.empty() && (found[0].index != expected.index || found[0].distance != expected.distance))) {
+            std::cerr << "suggestion mismatch for " << query << "\n";
+            std::abort();
+        }
+    }
+
+    const std::size_t rounds = 10;
+    const uint64_t elapsed_ref = bench::run(1, [&] {
+        for (const auto& query : queries) {
+            bench::keep(brute_force(words, query));
+        }
+    });
+    const uint64_t elapsed = bench::run(rounds, [&] {
+        for (const auto& query : queries) {
+            bench::keep(suggester->suggest(query));
+        }
+    });
+    bench::report("brute-force vs keyword_suggester", elapsed_ref * rounds, elapsed, rounds * queries.size());
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * Benchmark: symbol encoding (symbol_encoder/symbol_decoder) of a stream of field names, vs. raw length-prefixed
+ * strings: bytes saved, encode and decode throughput.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../fnv1a_symbol.h"
+#include "bench.h"
+
+// Raw encoding: 32-bit length, then bytes
+static void raw_encode(const std::vector<std::string_view>& values, std::string& out)
+{
+    for (const std::string_view value : values) {
+        const uint32_t size = uint32_t(value.size());
+        out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.append(value);
+    }
+}
+
+static std::size_t raw_decode(std::string_view data, std::string_view* values)
+{
+    std::size_t count = 0;
+    while (!data.empty()) {
+        uint32_t size;
+        std::memcpy(&size, data.data(), sizeof(size));
+        values[count++] = data.substr(sizeof(size), size);
+        data.remove_prefix(sizeof(size) + size);
+    }
+    return count;
+}
+
+static void report_rate(const std::string& name, uint64_t elapsed, std::size_t values, std::size_t bytes)
+{
+    std::cerr << "  " << name << ": " << (double(values) * 1000 / elapsed) << "M values/s, "
+              << (double(bytes) / elapsed) << "GB/s of input\n";
+}
+
+int main()
+{
+    // Field names such as "word.word_word", from the words.h list
+    const std::vector<std::string> words = bench::load_words("words.h");
+    bench::prng rnd;
+    std::vector<std::string> fields;
+    for (std::size_t i = 0; i < 2000; i++) {
+        fields.push_back(words[rnd.below(words.size())] + "." + words[rnd.below(words.size())] + "_"
+                         + words[rnd.below(words.size())]);
+    }
+    const symbol_table table(fields);
+
+    // Stream: 95% known fields, Zipf-like, and 5% unknown strings
+    const std::size_t count = std::size_t(1) << 22;
+    std::vector<std::string> unknown;
+    for (std::size_t i = 0; i < 1000; i++) {
+        unknown.push_back(bench::random_string(rnd, 8 + rnd.below(24)));
+    }
+    std::vector<std::string_view> values(count);
+    std::vector<uint64_t> ids(count);
+    std::vector<uint8_t> symbols(count); // Known fields longer than an ID
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        const bool known = rnd.below(100) < 95;
+        values[i] = known ? fields[rnd.below(rnd.below(fields.size()) + 1)] : unknown[rnd.below(unknown.size())];
+        ids[i] = fnv1a64::hash(values[i]);
+        symbols[i] = values[i].size() > sizeof(uint64_t) && table.contains(values[i], ids[i]);
+        bytes += values[i].size();
+    }
+    std::cerr << count << " values, " << table.size() << " known strings (" << table.memory() << " bytes of table), "
+              << (double(bytes) / count) << " bytes per value\n";
+
+    std::string raw;
+    const uint64_t elapsed_raw = bench::run(1, [&] { raw_encode(values, raw); });
+    std::vector<std::string_view> decoded(count);
+    const uint64_t elapsed_raw_decode = bench::run(1, [&] {
+        if (raw_decode(raw, decoded.data()) != count) {
+            std::abort();
+        }
+    });
+
+    symbol_encoder encoder(table);
+    const uint64_t elapsed = bench::run(1, [&] {
+        for (const std::string_view value : values) {
+            encoder.put(value);
+        }
+    });
+    const std::string encoded = encoder.data();
+    encoder.clear();
+    const uint64_t elapsed_batch = bench::run(1, [&] { encoder.put(values.data(), count); });
+    if (encoder.data() != encoded) {
+        std::cerr << "batch encoding mismatch\n";
+        std::abort();
+    }
+
+    // Known strings sent by compile-time ID, as with "name"_fnv1a64 literals
+    encoder.clear();
+    const uint64_t elapsed_ids = bench::run(1, [&] {
+        for (std::size_t i = 0; i < count; i++) {
+            if (symbols[i]) {
+                encoder.put_id(ids[i]);
+            } else {
+                encoder.put_inline(values[i]);
+            }
+        }
+    });
+    if (encoder.data() != encoded) {
+        std::cerr << "ID encoding mismatch\n";
+        std::abort();
+    }
+
+    symbol_decoder decoder(table, encoded);
+    std::size_t decoded_count = 0;
+    const uint64_t elapsed_decode = bench::run(1, [&] { decoded_count = decoder.next(decoded.data(), count); });
+    if (decoder.failed() || decoded_count != count || !std::equal(values.begin(), values.end(), decoded.begin())) {
+        std::cerr << "decoding mismatch\n";
+        std::abort();
+    }
+
+    std::cerr << "  raw: " << raw.size() << " bytes; symbols: " << encoded.size() << " bytes ("
+              << (100 - 100 * double(encoded.size()) / double(raw.size())) << "% saved)\n";
+    report_rate("raw encoding", elapsed_raw, count, bytes);
+    report_rate("symbol_encoder::put", elapsed, count, bytes);
+    report_rate("symbol_encoder::put, batch", elapsed_batch, count, bytes);
+    report_rate("symbol_encoder::put_id, compile-time IDs", elapsed_ids, count, bytes);
+    report_rate("raw decoding", elapsed_raw_decode, count, bytes);
+    report_rate("symbol_decoder::next", elapsed_decode, count, bytes);
+    return 0;
+}
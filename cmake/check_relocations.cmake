@@ -0,0 +1,13 @@
+# Count the dynamic relocations of a binary, and fail above a limit
+# cmake -DREADELF=<readelf> -DFILE=<binary> [-DMAX=<limit>] -P check_relocations.cmake
+execute_process(COMMAND ${READELF} -rW ${FILE} OUTPUT_VARIABLE relocations RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${READELF} failed on ${FILE}")
+endif()
+string(REGEX MATCHALL "\n[0-9a-f]+ +[0-9a-f]+ +R_" entries "${relocations}")
+list(LENGTH entries count)
+get_filename_component(name ${FILE} NAME)
+if(DEFINED MAX AND count GREATER MAX)
+  message(FATAL_ERROR "${name}: ${count} dynamic relocations (at most ${MAX} expected)")
+endif()
+message(STATUS "${name}: ${count} dynamic relocations")
@@ -0,0 +1,90 @@
+/**
+ * Arrow-style string columns, and batch Fnv1-a hashing of their rows.
+ * @comment Fnv1-a is a chain of dependent multiplications: hashing one string at a time is bound by the multiplication
+ * latency. Hashing several rows in lockstep keeps the multiplier busy, and yields exactly the same hashes.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+
+#include "switch_fnv1a.h"
+
+// String column: row i is bytes[offsets[i], offsets[i + 1]), as in the Arrow "utf8" (32-bit offsets) and "large_utf8"
+// (64-bit offsets, for more than 2 GiB of bytes) layouts
+template<typename Offset>
+struct basic_string_column
+{
+    const Offset* offsets; // rows + 1 offsets
+    const char* bytes;
+    std::size_t rows;
+
+    std::string_view operator[](std::size_t i) const
+    {
+        return std::string_view(bytes + offsets[i], std::size_t(offsets[i + 1] - offsets[i]));
+    }
+};
+
+using string_column = basic_string_column<int32_t>;
+using large_string_column = basic_string_column<int64_t>;
+
+/**
+ * Hash a range of rows of a column, as fnv1a<Bits>::hash() would
+ * @param column The column
+ * @param first The first row
+ * @param count The number of rows
+ * @param out The hashes, one per row
+ */
+template<std::size_t Bits, typename Offset>
+static inline void hash_column(const basic_string_column<Offset>& column,
+                               std::size_t first,
+                               std::size_t count,
+                               typename fnv1a<Bits>::Type* out)
+{
+    using Type = typename fnv1a<Bits>::Type;
+    constexpr Type prime = fnv1a_traits<Bits>::Prime;
+    constexpr std::size_t lanes = 4;
+
+    const std::size_t full = count - count % lanes;
+    for (std::size_t i = 0; i < full; i += lanes) {
+        const uint8_t* s[lanes];
+        std::size_t l[lanes];
+        Type h[lanes];
+        for (std::size_t lane = 0; lane < lanes; lane++) {
+            const std::string_view row = column[first + i + lane];
+            s[lane] = reinterpret_cast<const uint8_t*>(row.data());
+            l[lane] = row.size();
+            h[lane] = fnv1a_traits<Bits>::Offset;
+        }
+
+        // Lockstep over the common length, then each remaining tail
+        const std::size_t common = std::min(std::min(l[0], l[1]), std::min(l[2], l[3]));
+        Type h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3];
+        for (std::size_t j = 0; j < common; j++) {
+            h0 = (h0 ^ s[0][j]) * prime;
+            h1 = (h1 ^ s[1][j]) * prime;
+            h2 = (h2 ^ s[2][j]) * prime;
+            h3 = (h3 ^ s[3][j]) * prime;
+
+            // Keep the lanes in scalar registers: vector multiplications have a much longer latency
+            asm("" : "+r"(h0), "+r"(h1), "+r"(h2), "+r"(h3));
+        }
+        h[0] = h0;
+        h[1] = h1;
+        h[2] = h2;
+        h[3] = h3;
+        for (std::size_t lane = 0; lane < lanes; lane++) {
+            for (std::size_t j = common; j < l[lane]; j++) {
+                h[lane] = (h[lane] ^ s[lane][j]) * prime;
+            }
+            out[i + lane] = h[lane];
+        }
+    }
+    for (std::size_t i = full; i < count; i++) {
+        const std::string_view row = column[first + i];
+        out[i] = fnv1a<Bits>::hash(row.data(), row.size());
+    }
+}
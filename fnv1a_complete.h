@@ -0,0 +1,322 @@
+/**
+ * Prefix autocompletion over a keyword set: top-k completions of a prefix, by keyword score.
+ * @comment Keywords are stored sorted in a single blob, so that the completions of a prefix form a contiguous range.
+ * Short prefixes (up to 'depth' bytes) are resolved to their range by an Fnv1-a hash table; longer ones narrow the
+ * range of their leading 'depth' bytes with a binary search. The best-scored keywords of a range are then extracted
+ * with a range-maximum structure (sparse table over blocks), without scanning the whole range.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fnv1a_index.h"
+#include "switch_fnv1a.h"
+
+class keyword_completer
+{
+public:
+    using hasher = fnv1a64;
+
+    /**
+     * Build the index of a keyword list
+     * @param words The keywords (duplicates keep their best score)
+     * @param scores The keyword scores, higher first; by default, keywords listed first rank first
+     * @param depth The prefix length up to which ranges are found by hashing (at most 255)
+     */
+    explicit keyword_completer(const std::vector<std::string>& words,
+                               const std::vector<uint32_t>& scores = {},
+                               std::size_t depth = 3)
+      : _depth(std::min<std::size_t>(depth, 255))
+    {
+        // Sort, keeping the best score of duplicates
+        const auto score = [&](std::size_t i) { return scores.empty() ? uint32_t(words.size() - i) : scores[i]; };
+        std::vector<uint32_t> sorted(words.size());
+        std::iota(sorted.begin(), sorted.end(), 0);
+        std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+            const int c = words[a].compare(words[b]);
+            return c != 0 ? c < 0 : score(a) != score(b) ? score(a) > score(b) : a < b;
+        });
+        sorted.erase(std::unique(sorted.begin(),
+                                 sorted.end(),
+                                 [&](uint32_t a, uint32_t b) { return words[a] == words[b]; }),
+                     sorted.end());
+        _offsets.reserve(sorted.size() + 1);
+        _scores.reserve(sorted.size());
+        _order.reserve(sorted.size());
+        for (const uint32_t i : sorted) {
+            _offsets.push_back(uint32_t(_blob.size()));
+            _blob.append(words[i]);
+            _scores.push_back(score(i));
+            _order.push_back(i);
+        }
+        _offsets.push_back(uint32_t(_blob.size()));
+
+        build_ranges();
+        build_sparse();
+    }
+
+    /**
+     * Call on_completion(index, keyword) for the best-scored keywords starting with a prefix
+     * @param prefix The prefix
+     * @param k The maximum number of completions
+     * @param on_completion Function called with the keyword index (in the original list) and keyword, best first
+     * @return The number of completions
+     */
+    template<typename F>
+    std::size_t complete(std::string_view prefix, std::size_t k, F&& on_completion) const
+    {
+        std::size_t begin, end;
+        if (k == 0 || !find(prefix, begin, end)) {
+            return 0;
+        }
+
+        // Best of each pending range: extracting one keyword splits its range in two
+        struct pending
+        {
+            uint32_t best, begin, end;
+        };
+        pending buffer[32];
+        std::vector<pending> heap;
+        pending* ranges = buffer;
+        if (k + 1 > 32) {
+            heap.resize(k + 1);
+            ranges = heap.data();
+        }
+        std::size_t count = 0;
+        ranges[count++] = pending{ uint32_t(best(begin, end)), uint32_t(begin), uint32_t(end) };
+        std::size_t found = 0;
+        while (found < k && count != 0) {
+            std::size_t top = 0;
+            for (std::size_t i = 1; i < count; i++) {
+                if (better(ranges[i].best, ranges[top].best)) {
+                    top = i;
+                }
+            }
+            const pending r = ranges[top];
+            ranges[top] = ranges[--count];
+            on_completion(std::size_t(_order[r.best]), word(r.best));
+            found++;
+            if (r.begin < r.best) {
+                ranges[count++] = pending{ uint32_t(best(r.begin, r.best)), r.begin, r.best };
+            }
+            if (r.best + 1 < r.end) {
+                ranges[count++] = pending{ uint32_t(best(r.best + 1, r.end)), r.best + 1, r.end };
+            }
+        }
+        return found;
+    }
+
+    /**
+     * Top-k completions of a prefix
+     * @param prefix The prefix
+     * @param k The maximum number of completions
+     * @return The completions, best first
+     */
+    std::vector<std::string_view> complete(std::string_view prefix, std::size_t k = 10) const
+    {
+        std::vector<std::string_view> completions;
+        complete(prefix, k, [&](std::size_t, std::string_view w) { completions.push_back(w); });
+        return completions;
+    }
+
+    std::size_t size() const { return _order.size(); }
+
+    // Index memory footprint, in bytes (keywords included)
+    std::size_t memory() const
+    {
+        return _blob.size() + (_offsets.size() + _scores.size() + _order.size() + _sparse.size()) * sizeof(uint32_t)
+               + _slots.size() * sizeof(slot);
+    }
+
+private:
+    // Range-maximum granularity: ranges are scanned within a block
+    static constexpr std::size_t block = 8;
+
+    struct slot
+    {
+        uint32_t tag;   // High hash bits and prefix length, see tag()
+        uint32_t begin; // Range of the keywords starting with the prefix
+        uint32_t end;   // 0 if empty
+    };
+
+    std::string_view word(std::size_t i) const
+    {
+        return std::string_view(_blob.data() + _offsets[i], _offsets[i + 1] - _offsets[i]);
+    }
+
+    // Ranking: higher score first, then lexicographic order
+    bool better(std::size_t a, std::size_t b) const
+    {
+        return _scores[a] != _scores[b] ? _scores[a] > _scores[b] : a < b;
+    }
+
+    // Slot tag: a prefix and its extensions may start at the same keyword, so the length is part of the tag
+    static uint32_t tag(hasher::Type h, std::size_t length) { return uint32_t(h >> 40) << 8 | uint32_t(length); }
+
+    std::size_t index(hasher::Type h) const { return fnv1a_index::fibonacci(h, _bits); }
+
+    // Range of the keywords starting with a prefix
+    bool find(std::string_view prefix, std::size_t& begin, std::size_t& end) const
+    {
+        if (prefix.empty()) {
+            begin = 0;
+            end = _order.size();
+            return end != 0;
+        }
+        const std::size_t head = std::min(prefix.size(), _depth);
+        const hasher::Type h = hasher::hash(prefix.data(), head);
+        for (std::size_t i = index(h);; i = (i + 1) & _mask) {
+            const slot& s = _slots[i];
+            if (s.end == 0) {
+                return false;
+            }
+            if (s.tag == tag(h, head) && std::memcmp(word(s.begin).data(), prefix.data(), head) == 0) {
+                begin = s.begin;
+                end = s.end;
+                break;
+            }
+        }
+        if (head == prefix.size()) {
+            return true;
+        }
+
+        // Longer prefix: narrow the range, whose keywords share the first 'head' bytes
+        const std::string_view tail = prefix.substr(head);
+        std::size_t low = begin, high = end;
+        while (low < high) {
+            const std::size_t mid = low + (high - low) / 2;
+            if (word(mid).substr(head) < tail) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        begin = low;
+        for (high = end; low < high;) {
+            const std::size_t mid = low + (high - low) / 2;
+            if (word(mid).substr(head, tail.size()) == tail) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        end = low;
+        return begin != end;
+    }
+
+    // Best keyword in [begin, end), which must not be empty
+    std::size_t best(std::size_t begin, std::size_t end) const
+    {
+        const std::size_t first = (begin + block - 1) / block;
+        const std::size_t last = end / block;
+        std::size_t top = begin;
+        if (first < last) {
+            // Full blocks
+            unsigned level = 0;
+            while ((std::size_t(2) << level) <= last - first) {
+                level++;
+            }
+            const std::size_t blocks = (_order.size() + block - 1) / block;
+            const uint32_t* const row = &_sparse[level * blocks];
+            top = better(row[first], row[last - (std::size_t(1) << level)]) ? row[first]
+                                                                            : row[last - (std::size_t(1) << level)];
+            for (std::size_t i = begin; i < first * block; i++) {
+                top = better(i, top) ? i : top;
+            }
+            for (std::size_t i = last * block; i < end; i++) {
+                top = better(i, top) ? i : top;
+            }
+        } else {
+            for (std::size_t i = begin + 1; i < end; i++) {
+                top = better(i, top) ? i : top;
+            }
+        }
+        return top;
+    }
+
+    // Ranges of all prefixes up to _depth bytes
+    void build_ranges()
+    {
+        std::size_t prefixes = 0;
+        for (std::size_t length = 1; length <= _depth; length++) {
+            for (std::size_t i = 0; i < _order.size(); i++) {
+                const std::string_view w = word(i);
+                const bool shared = i != 0 && word(i - 1).size() >= length
+                                    && word(i - 1).compare(0, length, w, 0, length) == 0;
+                prefixes += w.size() >= length && !shared;
+            }
+        }
+        std::size_t bits = 4;
+        while ((std::size_t(1) << bits) < prefixes * 2) {
+            bits++;
+        }
+        _slots.assign(std::size_t(1) << bits, slot{ 0, 0, 0 });
+        _mask = _slots.size() - 1;
+        _bits = bits;
+
+        for (std::size_t length = 1; length <= _depth; length++) {
+            for (std::size_t i = 0; i < _order.size();) {
+                const std::string_view w = word(i);
+                if (w.size() < length) {
+                    i++;
+                    continue;
+                }
+                std::size_t j = i + 1;
+                while (j < _order.size() && word(j).size() >= length && word(j).compare(0, length, w, 0, length) == 0) {
+                    j++;
+                }
+                const hasher::Type h = hasher::hash(w.data(), length);
+                std::size_t s = index(h);
+                while (_slots[s].end != 0) {
+                    s = (s + 1) & _mask;
+                }
+                _slots[s] = slot{ tag(h, length), uint32_t(i), uint32_t(j) };
+                i = j;
+            }
+        }
+    }
+
+    // Sparse table over blocks: level l holds the best keyword of each run of 2^l blocks
+    void build_sparse()
+    {
+        const std::size_t blocks = (_order.size() + block - 1) / block;
+        unsigned levels = 1;
+        while ((std::size_t(2) << (levels - 1)) <= blocks) {
+            levels++;
+        }
+        _sparse.assign(levels * blocks, 0);
+        for (std::size_t b = 0; b < blocks; b++) {
+            std::size_t top = b * block;
+            for (std::size_t i = top + 1; i < std::min(_order.size(), (b + 1) * block); i++) {
+                top = better(i, top) ? i : top;
+            }
+            _sparse[b] = uint32_t(top);
+        }
+        for (unsigned level = 1; level < levels; level++) {
+            const uint32_t* const prev = &_sparse[(level - 1) * blocks];
+            uint32_t* const row = &_sparse[level * blocks];
+            const std::size_t half = std::size_t(1) << (level - 1);
+            for (std::size_t b = 0; b + 2 * half <= blocks; b++) {
+                row[b] = better(prev[b], prev[b + half]) ? prev[b] : prev[b + half];
+            }
+        }
+    }
+
+    std::size_t _depth;
+    std::string _blob;              // Sorted keywords
+    std::vector<uint32_t> _offsets; // Keyword offsets in _blob, plus the final size
+    std::vector<uint32_t> _scores;  // Keyword scores
+    std::vector<uint32_t> _order;   // Keyword index in the original list
+    std::vector<uint32_t> _sparse;  // Range-maximum table
+    std::vector<slot> _slots;       // Prefix ranges
+    std::size_t _mask = 0;
+    unsigned _bits = 0;
+};
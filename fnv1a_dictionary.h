@@ -0,0 +1,98 @@
+/**
+ * Dictionary encoding of string columns into dense codes, using batch Fnv1-a hashing.
+ * @comment Values get dense uint32_t codes through a group_table, whose keys are stored in a single arena: the
+ * dictionary is that arena, as a column indexed by code. The parallel variant encodes chunks with per-thread tables,
+ * then merges the thread dictionaries in chunk order, so that codes are the same as with a single thread.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "fnv1a_groupby.h"
+
+template<std::size_t Bits = 64>
+class dictionary_encoder
+{
+public:
+    static constexpr std::size_t batch = group_table<Bits>::batch;
+
+    /**
+     * Encode a column; the dictionary grows with the new values
+     * @comment New values get the next codes, in order of first appearance
+     * @param column The column
+     * @param codes The code of each row
+     */
+    template<typename Offset>
+    void encode(const basic_string_column<Offset>& column, uint32_t* codes)
+    {
+        _table.assign(column, codes);
+    }
+
+    /**
+     * Encode a column using several threads; codes and dictionary are the same as with encode()
+     * @param column The column
+     * @param codes The code of each row
+     * @param threads The number of threads
+     */
+    template<typename Offset>
+    void encode_parallel(const basic_string_column<Offset>& column, uint32_t* codes, unsigned threads)
+    {
+        // At least a batch per thread
+        threads = unsigned(std::max<std::size_t>(1, std::min<std::size_t>(threads, column.rows / batch)));
+        if (threads == 1) {
+            encode(column, codes);
+            return;
+        }
+        const auto begin = [&](unsigned t) { return column.rows * t / threads; };
+
+        // Local codes, in per-thread tables
+        std::vector<group_table<Bits>> locals(threads);
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                locals[t].assign(
+                  basic_string_column<Offset>{ column.offsets + begin(t), column.bytes, begin(t + 1) - begin(t) },
+                  codes + begin(t));
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+
+        // Merge the dictionaries in chunk order (hashes are reused), then translate the local codes
+        std::vector<std::vector<uint32_t>> remap(threads);
+        for (unsigned t = 0; t < threads; t++) {
+            remap[t].resize(locals[t].size());
+            for (uint32_t id = 0; id < locals[t].size(); id++) {
+                remap[t][id] = _table.insert(locals[t].key(id), locals[t].hash(id));
+            }
+            locals[t] = group_table<Bits>();
+        }
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                const uint32_t* const to = remap[t].data();
+                for (std::size_t i = begin(t); i < begin(t + 1); i++) {
+                    codes[i] = to[codes[i]];
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Dictionary: value of each code
+    large_string_column dictionary() const { return _table.keys(); }
+
+    // Number of distinct values
+    std::size_t size() const { return _table.size(); }
+
+private:
+    group_table<Bits> _table;
+};
@@ -0,0 +1,340 @@
+/**
+ * Approximate set membership over precomputed Fnv1-a hashes: a blocked bloom filter and a (deletable) cuckoo filter.
+ * @comment Both filters take fnv1a64 or fnv1a128 values. The last input bytes of FNV barely reach its high bits: the
+ * two derived values are multiplicative remixes (whose high bits depend on every hash bit) of the 64-bit hash, or of
+ * each half of the 128-bit hash. The bloom filter sets 8 bits in a single 256-bit block (one cache access per key, a
+ * single AVX2 test per probe); the cuckoo filter stores 16-bit fingerprints in buckets of 4, probed with SWAR
+ * comparisons. Batch probes prefetch the blocks or buckets of the whole batch first.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "switch_fnv1a.h"
+
+// Two 64-bit hash values derived from an Fnv1-a hash
+struct filter_key
+{
+    uint64_t a; // Selects the block or bucket (high bits)
+    uint64_t b; // Selects the bits or fingerprint (high bits)
+
+    static filter_key of(fnv1a64::Type h)
+    {
+        return filter_key{ h * 0x9e3779b97f4a7c15, (h ^ (h >> 32)) * 0xc2b2ae3d27d4eb4f };
+    }
+
+    static filter_key of(fnv1a128::Type h)
+    {
+        return filter_key{ uint64_t(h >> 64) * 0x9e3779b97f4a7c15, uint64_t(h) * 0xc2b2ae3d27d4eb4f };
+    }
+};
+
+namespace filter_detail {
+// Map a 64-bit value to [0, n) using its high bits
+static inline std::size_t reduce(uint64_t value, std::size_t n)
+{
+    return std::size_t((__uint128_t(value) * n) >> 64);
+}
+
+// Probe a batch: prefetch every key location, then test every key
+template<typename Filter, typename H>
+static void contains(const Filter& filter, const H* hashes, std::size_t count, bool* out)
+{
+    constexpr std::size_t batch = 64;
+    filter_key keys[batch];
+    for (std::size_t first = 0; first < count; first += batch) {
+        const std::size_t size = std::min(batch, count - first);
+        for (std::size_t i = 0; i < size; i++) {
+            keys[i] = filter_key::of(hashes[first + i]);
+            filter.prefetch(keys[i]);
+        }
+        for (std::size_t i = 0; i < size; i++) {
+            out[first + i] = filter.contains(keys[i]);
+        }
+    }
+}
+} // namespace filter_detail
+
+// Bloom filter whose bits for a key all lie in one 256-bit block (split block bloom filter)
+class blocked_bloom_filter
+{
+public:
+    /**
+     * Create a filter
+     * @param keys The expected number of keys
+     * @param bits_per_key The memory budget per key (about 0.5% false positives at 12 bits/key)
+     */
+    explicit blocked_bloom_filter(std::size_t keys, double bits_per_key = 12)
+      : _blocks(std::max<std::size_t>(1, std::size_t(double(keys) * bits_per_key / 256 + 1)))
+    {}
+
+    void insert(const filter_key& key)
+    {
+        uint32_t* const words = _blocks[block(key)].words;
+        const uint32_t bits = uint32_t(key.b >> 32);
+        for (std::size_t i = 0; i < 8; i++) {
+            words[i] |= uint32_t(1) << ((bits * salt[i]) >> 27);
+        }
+    }
+
+    bool contains(const filter_key& key) const
+    {
+        const block_t& b = _blocks[block(key)];
+        const uint32_t bits = uint32_t(key.b >> 32);
+#if defined(__AVX2__)
+        const __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(salt));
+        const __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(int(bits)), salts), 27);
+        const __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+        return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(b.words)), mask);
+#else
+        uint32_t missing = 0;
+        for (std::size_t i = 0; i < 8; i++) {
+            const uint32_t bit = uint32_t(1) << ((bits * salt[i]) >> 27);
+            missing |= bit & ~b.words[i];
+        }
+        return missing == 0;
+#endif
+    }
+
+    void prefetch(const filter_key& key) const { __builtin_prefetch(&_blocks[block(key)]); }
+
+    template<typename H>
+    void insert(H hash)
+    {
+        insert(filter_key::of(hash));
+    }
+
+    template<typename H>
+    bool contains(H hash) const
+    {
+        return contains(filter_key::of(hash));
+    }
+
+    /**
+     * Probe a batch of hashes
+     * @param hashes The fnv1a64 or fnv1a128 hashes
+     * @param count The number of hashes
+     * @param out The result for each hash
+     */
+    template<typename H>
+    void contains(const H* hashes, std::size_t count, bool* out) const
+    {
+        filter_detail::contains(*this, hashes, count, out);
+    }
+
+    // Memory footprint, in bytes
+    std::size_t memory() const { return _blocks.size() * sizeof(block_t); }
+
+private:
+    // Odd multipliers, one per 32-bit word of a block
+    static constexpr uint32_t salt[8] = { 0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                          0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U };
+
+    struct alignas(32) block_t
+    {
+        uint32_t words[8];
+    };
+
+    std::size_t block(const filter_key& key) const { return filter_detail::reduce(key.a, _blocks.size()); }
+
+    std::vector<block_t> _blocks;
+};
+
+// Cuckoo filter: 16-bit fingerprints, buckets of 4, deletable
+class cuckoo_filter
+{
+public:
+    // Slots per bucket
+    static constexpr std::size_t slots = 4;
+
+    /**
+     * Create a filter
+     * @param keys The capacity, filled at a 95% load factor
+     */
+    explicit cuckoo_filter(std::size_t keys)
+      : _buckets(std::max<std::size_t>(2, std::size_t(double(keys) / (slots * 0.95)) + 1), 0)
+    {}
+
+    /**
+     * Insert a key
+     * @comment Once a fingerprint could not be placed, it is kept aside and the filter is full
+     * @return false if the filter is full (the key is then not inserted)
+     */
+    bool insert(const filter_key& key)
+    {
+        if (_victim.used) {
+            return false;
+        }
+        insert(first(key), fingerprint(key));
+        return true;
+    }
+
+    /**
+     * Remove a key, which must have been inserted
+     * @return false if the key was not found
+     */
+    bool erase(const filter_key& key)
+    {
+        const uint16_t fp = fingerprint(key);
+        const std::size_t i = first(key);
+        if (remove(i, fp) || remove(alternate(i, fp), fp)) {
+            if (_victim.used) {
+                // Room again for the fingerprint kept aside
+                _victim.used = false;
+                insert(_victim.index, _victim.fp);
+            }
+            return true;
+        }
+        if (_victim.used && _victim.fp == fp && (_victim.index == i || _victim.index == alternate(i, fp))) {
+            _victim.used = false;
+            return true;
+        }
+        return false;
+    }
+
+    bool contains(const filter_key& key) const
+    {
+        const uint16_t fp = fingerprint(key);
+        const std::size_t i = first(key);
+        const std::size_t j = alternate(i, fp);
+        return has(_buckets[i], fp) | has(_buckets[j], fp)
+               | (_victim.used & (_victim.fp == fp) & ((_victim.index == i) | (_victim.index == j)));
+    }
+
+    void prefetch(const filter_key& key) const
+    {
+        const std::size_t i = first(key);
+        __builtin_prefetch(&_buckets[i]);
+        __builtin_prefetch(&_buckets[alternate(i, fingerprint(key))]);
+    }
+
+    template<typename H>
+    bool insert(H hash)
+    {
+        return insert(filter_key::of(hash));
+    }
+
+    template<typename H>
+    bool erase(H hash)
+    {
+        return erase(filter_key::of(hash));
+    }
+
+    template<typename H>
+    bool contains(H hash) const
+    {
+        return contains(filter_key::of(hash));
+    }
+
+    /**
+     * Probe a batch of hashes
+     * @param hashes The fnv1a64 or fnv1a128 hashes
+     * @param count The number of hashes
+     * @param out The result for each hash
+     */
+    template<typename H>
+    void contains(const H* hashes, std::size_t count, bool* out) const
+    {
+        filter_detail::contains(*this, hashes, count, out);
+    }
+
+    // Memory footprint, in bytes
+    std::size_t memory() const { return _buckets.size() * sizeof(uint64_t); }
+
+private:
+    static constexpr std::size_t max_kicks = 500;
+    static constexpr uint64_t lanes = 0x0001000100010001ULL;
+
+    struct victim
+    {
+        std::size_t index;
+        uint16_t fp;
+        bool used;
+    };
+
+    // Non-zero fingerprint: zero marks an empty slot
+    static uint16_t fingerprint(const filter_key& key)
+    {
+        const uint16_t fp = uint16_t(key.b >> 48);
+        return fp != 0 ? fp : 1;
+    }
+
+    std::size_t first(const filter_key& key) const { return filter_detail::reduce(key.a, _buckets.size()); }
+
+    // Alternate bucket, an involution: alternate(alternate(i, fp), fp) == i
+    std::size_t alternate(std::size_t i, uint16_t fp) const
+    {
+        const std::size_t n = _buckets.size();
+        const std::size_t h = filter_detail::reduce(fp * 0x9e3779b97f4a7c15, n);
+        return h >= i ? h - i : h + n - i;
+    }
+
+    static uint16_t get(uint64_t bucket, unsigned slot) { return uint16_t(bucket >> (16 * slot)); }
+
+    static void set(uint64_t& bucket, unsigned slot, uint16_t fp)
+    {
+        bucket = (bucket & ~(uint64_t(0xffff) << (16 * slot))) | (uint64_t(fp) << (16 * slot));
+    }
+
+    // SWAR "haszero" on 16-bit lanes: exact for the lowest matching lane
+    static uint64_t matches(uint64_t bucket, uint16_t fp)
+    {
+        const uint64_t v = bucket ^ (fp * lanes);
+        return (v - lanes) & ~v & (lanes << 15);
+    }
+
+    static bool has(uint64_t bucket, uint16_t fp) { return matches(bucket, fp) != 0; }
+
+    bool add(std::size_t i, uint16_t fp)
+    {
+        const uint64_t empty = matches(_buckets[i], 0);
+        if (empty == 0) {
+            return false;
+        }
+        set(_buckets[i], unsigned(__builtin_ctzll(empty) / 16), fp);
+        return true;
+    }
+
+    bool remove(std::size_t i, uint16_t fp)
+    {
+        const uint64_t found = matches(_buckets[i], fp);
+        if (found == 0) {
+            return false;
+        }
+        set(_buckets[i], unsigned(__builtin_ctzll(found) / 16), 0);
+        return true;
+    }
+
+    // Insert a fingerprint, evicting fingerprints to their alternate bucket if needed; the last one is kept aside
+    void insert(std::size_t i, uint16_t fp)
+    {
+        if (add(i, fp) || add(alternate(i, fp), fp)) {
+            return;
+        }
+        for (std::size_t kick = 0; kick < max_kicks; kick++) {
+            _random = _random * 6364136223846793005ULL + 1442695040888963407ULL;
+            const unsigned slot = unsigned(_random >> 62);
+            const uint16_t evicted = get(_buckets[i], slot);
+            set(_buckets[i], slot, fp);
+            fp = evicted;
+            i = alternate(i, fp);
+            if (add(i, fp)) {
+                return;
+            }
+        }
+        _victim = victim{ i, fp, true };
+    }
+
+    std::vector<uint64_t> _buckets;
+    victim _victim = { 0, 0, false };
+    uint64_t _random = 0x9e3779b97f4a7c15;
+};
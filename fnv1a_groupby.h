@@ -0,0 +1,230 @@
+/**
+ * Group-by aggregation over string columns, using batch Fnv1-a hashing.
+ * @comment Rows are processed in batches: the batch is hashed first (see hash_column), then its table slots are
+ * prefetched, then each row gets a dense group ID, verified against the group key. Aggregates are kept as columns
+ * indexed by group ID, and updated by a separate loop, free of hashing and branches.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fnv1a_column.h"
+#include "fnv1a_index.h"
+#include "fnv1a_memory.h"
+
+// Dense group IDs of string keys
+template<std::size_t Bits = 64>
+class group_table
+{
+public:
+    using Type = typename fnv1a<Bits>::Type;
+
+    // Rows hashed and prefetched at once
+    static constexpr std::size_t batch = 256;
+
+    /**
+     * Create an empty table
+     * @param capacity The initial number of slots
+     * @param options Slot table allocation options (huge pages, prefaulting), for millions of groups
+     */
+    explicit group_table(std::size_t capacity = 16, const page_options& options = page_options())
+      : _slots(page_allocator<slot>(options))
+    {
+        rehash(capacity);
+    }
+
+    /**
+     * Assign group IDs to the rows of a column
+     * @comment New keys get the next IDs, in order of first appearance
+     * @param column The column
+     * @param ids The group ID of each row
+     */
+    template<typename Offset>
+    void assign(const basic_string_column<Offset>& column, uint32_t* ids)
+    {
+        Type hashes[batch];
+        for (std::size_t first = 0; first < column.rows; first += batch) {
+            const std::size_t count = std::min(batch, column.rows - first);
+            hash_column<Bits>(column, first, count, hashes);
+
+            // Make room for the whole batch first, so that no rehash happens after the prefetch
+            while ((_hashes.size() + count) * 2 > _slots.size()) {
+                rehash(_slots.size() * 2);
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                __builtin_prefetch(&_slots[index(hashes[i])]);
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                ids[first + i] = insert(column[first + i], hashes[i]);
+            }
+        }
+    }
+
+    /**
+     * Group ID of a key, added if new
+     * @param key The key
+     * @param h The key hash, as returned by fnv1a<Bits>::hash()
+     * @return The group ID
+     */
+    uint32_t insert(std::string_view key, Type h)
+    {
+        if ((_hashes.size() + 1) * 2 > _slots.size()) {
+            rehash(_slots.size() * 2);
+        }
+        const uint32_t t = tag(h);
+        for (std::size_t i = index(h);; i = (i + 1) & _mask) {
+            slot& s = _slots[i];
+            if (s.id == 0) {
+                const uint32_t id = uint32_t(_hashes.size());
+                _hashes.push_back(h);
+                _blob.append(key);
+                _offsets.push_back(int64_t(_blob.size()));
+                s = slot{ t, id + 1 };
+                return id;
+            }
+            if (s.tag == t) {
+                const uint32_t id = s.id - 1;
+                const int64_t offset = _offsets[id];
+                if (std::size_t(_offsets[id + 1] - offset) == key.size()
+                    && std::memcmp(_blob.data() + offset, key.data(), key.size()) == 0) {
+                    return id;
+                }
+            }
+        }
+    }
+
+    // Number of groups
+    std::size_t size() const { return _hashes.size(); }
+
+    // Group key, by ID
+    std::string_view key(uint32_t id) const { return keys()[id]; }
+
+    // Group key hash, by ID
+    Type hash(uint32_t id) const { return _hashes[id]; }
+
+    // Group keys, as a column indexed by group ID (64-bit offsets: keys may exceed 2 GiB in total)
+    large_string_column keys() const { return large_string_column{ _offsets.data(), _blob.data(), _hashes.size() }; }
+
+private:
+    struct slot
+    {
+        uint32_t tag; // High hash bits
+        uint32_t id;  // 1-based group ID, 0 if empty
+    };
+
+    static uint32_t tag(Type h) { return uint32_t(h >> (Bits - 32)); }
+
+    std::size_t index(Type h) const
+    {
+        if constexpr (Bits > 64) {
+            return fnv1a_index::fibonacci(fnv1a_index::fold(h), _bits);
+        } else {
+            return fnv1a_index::fibonacci(h, _bits);
+        }
+    }
+
+    void rehash(std::size_t capacity)
+    {
+        std::size_t bits = 4;
+        while ((std::size_t(1) << bits) < capacity) {
+            bits++;
+        }
+        _slots.assign(std::size_t(1) << bits, slot{ 0, 0 });
+        _mask = _slots.size() - 1;
+        _bits = bits;
+        for (std::size_t id = 0; id < _hashes.size(); id++) {
+            std::size_t i = index(_hashes[id]);
+            while (_slots[i].id != 0) {
+                i = (i + 1) & _mask;
+            }
+            _slots[i] = slot{ tag(_hashes[id]), uint32_t(id + 1) };
+        }
+    }
+
+    std::vector<slot, page_allocator<slot>> _slots;
+    std::vector<Type> _hashes;             // Group hashes, for rehashing
+    std::string _blob;                     // Group keys
+    std::vector<int64_t> _offsets = { 0 }; // Group key offsets in _blob, plus the final size
+    std::size_t _mask = 0;
+    unsigned _bits = 0;
+};
+
+// Per-group aggregates, as columns indexed by group ID
+template<typename Value>
+struct group_aggregates
+{
+    std::vector<uint64_t> count;
+    std::vector<Value> sum;
+    std::vector<Value> min;
+    std::vector<Value> max;
+
+    /**
+     * Aggregate the values of a batch of rows
+     * @param ids The group ID of each row
+     * @param values The value of each row
+     * @param rows The number of rows
+     * @param groups The total number of groups
+     */
+    void update(const uint32_t* ids, const Value* values, std::size_t rows, std::size_t groups)
+    {
+        if (count.size() < groups) {
+            count.resize(groups, 0);
+            sum.resize(groups, Value());
+            min.resize(groups, std::numeric_limits<Value>::max());
+            max.resize(groups, std::numeric_limits<Value>::lowest());
+        }
+        uint64_t* const c = count.data();
+        Value* const s = sum.data();
+        Value* const lo = min.data();
+        Value* const hi = max.data();
+        for (std::size_t i = 0; i < rows; i++) {
+            const uint32_t id = ids[i];
+            const Value value = values[i];
+            c[id]++;
+            s[id] += value;
+            lo[id] = std::min(lo[id], value);
+            hi[id] = std::max(hi[id], value);
+        }
+    }
+};
+
+// Group-by aggregation of a value column by a string column
+template<typename Value, std::size_t Bits = 64>
+class string_group_by
+{
+public:
+    // Rows whose group IDs are assigned before being aggregated
+    static constexpr std::size_t chunk = 4096;
+
+    /**
+     * Aggregate rows
+     * @param keys The key column
+     * @param values The value column, with as many rows as keys
+     */
+    template<typename Offset>
+    void add(const basic_string_column<Offset>& keys, const Value* values)
+    {
+        uint32_t ids[chunk];
+        for (std::size_t first = 0; first < keys.rows; first += chunk) {
+            const std::size_t count = std::min(chunk, keys.rows - first);
+            _groups.assign(basic_string_column<Offset>{ keys.offsets + first, keys.bytes, count }, ids);
+            _aggregates.update(ids, values + first, count, _groups.size());
+        }
+    }
+
+    const group_table<Bits>& groups() const { return _groups; }
+
+    const group_aggregates<Value>& aggregates() const { return _aggregates; }
+
+private:
+    group_table<Bits> _groups;
+    group_aggregates<Value> _aggregates;
+};
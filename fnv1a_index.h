@@ -0,0 +1,77 @@
+/**
+ * Table index derivation from Fnv1-a hashes: the ways of mapping a hash to one of 2^bits (or n) slots.
+ * @comment FNV-1a multiplies by a sparse prime, and a product only carries upwards: the low k bits of the hash only
+ * depend on the low k bits of every step (bit 0 is the parity of the input bytes' low bits), while the last input
+ * bytes reach the high bits only through carries. Masking the low bits or taking the high bits directly is fast, but
+ * can lengthen probe sequences; the fibonacci and mix methods spread every hash bit over the index bits. The tables of
+ * this repository index their slots with fibonacci (one multiplication: the well-mixed low bits are carried into the
+ * high bits it keeps, next to the high bits themselves), folding 128-bit hashes first; partitioning and fingerprinting,
+ * which use the raw bits, go through mix. The tools/hash_audit program measures each method over a given key list.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace fnv1a_index {
+
+// 64-bit finalizer (MurmurHash3 fmix64): every output bit depends on every input bit
+static constexpr uint64_t mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccd;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53;
+    h ^= h >> 33;
+    return h;
+}
+
+// Low hash bits
+static constexpr std::size_t low_bits(uint64_t h, unsigned bits)
+{
+    return h & ((uint64_t(1) << bits) - 1);
+}
+
+// High hash bits
+static constexpr std::size_t high_bits(uint64_t h, unsigned bits)
+{
+    return h >> (64 - bits);
+}
+
+// Fast range reduction to [0, n), for tables that are not a power of two (Lemire)
+static constexpr std::size_t fast_range(uint64_t h, std::size_t n)
+{
+    return std::size_t((__uint128_t(h) * n) >> 64);
+}
+
+// XOR-folding, as suggested by the FNV specification: 64 to 32 bits, then the remaining high bits onto the low bits
+static constexpr std::size_t xor_fold(uint64_t h, unsigned bits)
+{
+    const uint64_t folded = (h ^ (h >> 32)) & 0xffffffff;
+    return (folded ^ (folded >> bits)) & ((uint64_t(1) << bits) - 1);
+}
+
+// 2^64 / golden ratio, odd
+static constexpr uint64_t golden = 0x9e3779b97f4a7c15;
+
+// Fibonacci hashing: high bits of the hash times 2^64 / golden ratio
+static constexpr std::size_t fibonacci(uint64_t h, unsigned bits)
+{
+    return (h * golden) >> (64 - bits);
+}
+
+// High bits of the finalized hash
+static constexpr std::size_t mixed(uint64_t h, unsigned bits)
+{
+    return mix(h) >> (64 - bits);
+}
+
+// 64-bit table hash of an fnv1a128 hash, as used by the tables of this repository
+static constexpr uint64_t fold(__uint128_t h)
+{
+    return uint64_t(h) ^ uint64_t(h >> 64);
+}
+
+} // namespace fnv1a_index
@@ -0,0 +1,245 @@
+/**
+ * Hash join of string columns on fnv1a64 hashes.
+ * @comment The build side is stored as (hash, row) pairs in a flat linear-probing table; duplicate keys take one slot
+ * each. Probes are hashed and prefetched by batches, and compare strings only when the full 64-bit hashes match. The
+ * partitioned variant first splits both sides on the high hash bits (see radix_partitioner), so that each partition
+ * table fits in the cache, and joins the partitions in parallel.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "fnv1a_index.h"
+#include "fnv1a_memory.h"
+#include "fnv1a_partition.h"
+
+// A joined pair of rows
+struct join_match
+{
+    uint64_t build;
+    uint64_t probe;
+};
+
+// Table of hashed build rows
+class join_table
+{
+public:
+    // Probe rows hashed and prefetched at once
+    static constexpr std::size_t batch = 256;
+
+    /**
+     * Create an empty table
+     * @param options Slot table allocation options (huge pages, prefaulting), for large build sides
+     */
+    explicit join_table(const page_options& options = page_options())
+      : _slots(page_allocator<slot>(options))
+    {}
+
+    /**
+     * Build the table
+     * @param rows The hashed build rows
+     * @param count The number of rows
+     */
+    void build(const hashed_row* rows, std::size_t count)
+    {
+        std::size_t bits = 4;
+        while ((std::size_t(1) << bits) < count * 2) {
+            bits++;
+        }
+        _slots.assign(std::size_t(1) << bits, slot{ 0, 0 });
+        _mask = _slots.size() - 1;
+        _bits = unsigned(bits);
+        for (std::size_t i = 0; i < count; i++) {
+            std::size_t s = index(rows[i].hash);
+            while (_slots[s].row != 0) {
+                s = (s + 1) & _mask;
+            }
+            _slots[s] = slot{ rows[i].hash, rows[i].row + 1 };
+        }
+    }
+
+    /**
+     * Probe the table
+     * @param rows The hashed probe rows
+     * @param count The number of rows
+     * @param build The build column, to verify the keys
+     * @param probe The probe column (of the same offset type or not)
+     * @param on_match Function called with each join_match
+     */
+    template<typename BuildOffset, typename ProbeOffset, typename F>
+    void probe(const hashed_row* rows,
+               std::size_t count,
+               const basic_string_column<BuildOffset>& build,
+               const basic_string_column<ProbeOffset>& probe,
+               F&& on_match) const
+    {
+        for (std::size_t first = 0; first < count; first += batch) {
+            const std::size_t last = std::min(count, first + batch);
+            for (std::size_t i = first; i < last; i++) {
+                __builtin_prefetch(&_slots[index(rows[i].hash)]);
+            }
+            for (std::size_t i = first; i < last; i++) {
+                const uint64_t h = rows[i].hash;
+                for (std::size_t s = index(h); _slots[s].row != 0; s = (s + 1) & _mask) {
+                    if (_slots[s].hash == h) {
+                        const uint64_t row = _slots[s].row - 1;
+                        if (build[row] == probe[rows[i].row]) {
+                            on_match(join_match{ row, rows[i].row });
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    struct slot
+    {
+        uint64_t hash;
+        uint64_t row; // 1-based build row, 0 if empty
+    };
+
+    std::size_t index(uint64_t h) const { return fnv1a_index::fibonacci(h, _bits); }
+
+    std::vector<slot, page_allocator<slot>> _slots;
+    std::size_t _mask = 0;
+    unsigned _bits = 0;
+};
+
+// Join against a build column, of 32-bit (hash_join) or 64-bit (large_hash_join) offsets
+template<typename Offset>
+class basic_hash_join
+{
+public:
+    /**
+     * Build the join table
+     * @param build The build column, which must outlive the join
+     * @param options Table allocation options (huge pages, prefaulting), for large build sides
+     */
+    explicit basic_hash_join(const basic_string_column<Offset>& build, const page_options& options = page_options())
+      : _build(build)
+      , _table(options)
+    {
+        std::vector<uint64_t> hashes(build.rows);
+        hash_column<64>(build, 0, build.rows, hashes.data());
+        std::vector<hashed_row> rows(build.rows);
+        for (std::size_t i = 0; i < build.rows; i++) {
+            rows[i] = hashed_row{ hashes[i], i };
+        }
+        _table.build(rows.data(), rows.size());
+    }
+
+    /**
+     * Join a probe column
+     * @param probe The probe column (of the same offset type or not)
+     * @param on_match Function called with each join_match, by probe row
+     */
+    template<typename ProbeOffset, typename F>
+    void probe(const basic_string_column<ProbeOffset>& probe, F&& on_match) const
+    {
+        constexpr std::size_t batch = join_table::batch;
+        uint64_t hashes[batch];
+        hashed_row rows[batch];
+        for (std::size_t first = 0; first < probe.rows; first += batch) {
+            const std::size_t count = std::min(batch, probe.rows - first);
+            hash_column<64>(probe, first, count, hashes);
+            for (std::size_t i = 0; i < count; i++) {
+                rows[i] = hashed_row{ hashes[i], first + i };
+            }
+            _table.probe(rows, count, _build, probe, on_match);
+        }
+    }
+
+private:
+    basic_string_column<Offset> _build;
+    join_table _table;
+};
+
+using hash_join = basic_hash_join<int32_t>;
+using large_hash_join = basic_hash_join<int64_t>;
+
+/**
+ * Radix-partitioned parallel hash join
+ * @comment Build sides small enough for the cache are not partitioned: the threads probe a shared table
+ * @param build The build column
+ * @param probe The probe column (of the same offset type or not)
+ * @param threads The number of threads
+ * @return The matches, grouped by partition (by probe chunk for small build sides)
+ */
+template<typename BuildOffset, typename ProbeOffset>
+static inline std::vector<join_match> partitioned_hash_join(const basic_string_column<BuildOffset>& build,
+                                                            const basic_string_column<ProbeOffset>& probe,
+                                                            unsigned threads)
+{
+    // Partitions of about 8K build rows: their table (256KB) stays in the cache
+    constexpr std::size_t partition_rows = 8192;
+    unsigned bits = 0;
+    while (bits < 14 && (build.rows >> bits) > partition_rows) {
+        bits++;
+    }
+    threads = std::max(1u, threads);
+    const std::size_t count = std::size_t(1) << bits;
+    std::vector<std::vector<join_match>> matches(std::max<std::size_t>(count, threads));
+    const auto parallel = [threads](auto&& fun) {
+        if (threads == 1) {
+            fun(0);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back(fun, t);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    };
+
+    if (bits == 0) {
+        // Probe chunks, by thread
+        const basic_hash_join<BuildOffset> join(build);
+        parallel([&](unsigned t) {
+            const std::size_t first = probe.rows * t / threads;
+            const basic_string_column<ProbeOffset> chunk = { probe.offsets + first,
+                                                             probe.bytes,
+                                                             probe.rows * (t + 1) / threads - first };
+            join.probe(chunk, [&](const join_match& match) {
+                matches[t].push_back(join_match{ match.build, first + match.probe });
+            });
+        });
+    } else {
+        radix_partitioner build_partitions(bits);
+        radix_partitioner probe_partitions(bits);
+        build_partitions.partition(build, threads);
+        probe_partitions.partition(probe, threads);
+
+        // Partitions, interleaved among threads
+        parallel([&](unsigned t) {
+            join_table table;
+            for (std::size_t p = t; p < count; p += threads) {
+                table.build(build_partitions.begin(p), build_partitions.end(p) - build_partitions.begin(p));
+                table.probe(probe_partitions.begin(p),
+                            probe_partitions.end(p) - probe_partitions.begin(p),
+                            build,
+                            probe,
+                            [&](const join_match& match) { matches[p].push_back(match); });
+            }
+        });
+    }
+
+    std::size_t total = 0;
+    for (const auto& partition : matches) {
+        total += partition.size();
+    }
+    std::vector<join_match> all;
+    all.reserve(total);
+    for (const auto& partition : matches) {
+        all.insert(all.end(), partition.begin(), partition.end());
+    }
+    return all;
+}
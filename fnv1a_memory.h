@@ -0,0 +1,187 @@
+/**
+ * Page-level allocation options for large hash tables: huge pages, prefaulting, cache-line alignment.
+ * @comment A lookup in a table of millions of keys lands on a random page: with 4 KiB pages, nearly every lookup also
+ * misses the TLB, and walks the page tables. 2 MiB pages cover 512 times more memory per TLB entry. They are either
+ * transparent (madvise(MADV_HUGEPAGE), when /sys/kernel/mm/transparent_hugepage/enabled is "madvise" or "always") or
+ * explicit (MAP_HUGETLB, from the pages reserved in /proc/sys/vm/nr_hugepages). Explicit huge pages fall back to
+ * transparent ones when none are reserved. Prefaulting (MAP_POPULATE) maps all pages at allocation time, in one system
+ * call, instead of one page fault per page on first touch. Without any option, tables are allocated with new, aligned
+ * on a cache line.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define FNV1A_MEMORY_MMAP
+#endif
+
+// Table allocation options
+struct page_options
+{
+    bool huge_pages = false;          // Transparent huge pages: madvise(MADV_HUGEPAGE)
+    bool explicit_huge_pages = false; // MAP_HUGETLB, or transparent huge pages if none are available
+    bool populate = false;            // Map all pages at allocation (MAP_POPULATE)
+
+    bool any() const { return huge_pages || explicit_huge_pages || populate; }
+
+    bool operator==(const page_options& other) const
+    {
+        return huge_pages == other.huge_pages && explicit_huge_pages == other.explicit_huge_pages
+               && populate == other.populate;
+    }
+    bool operator!=(const page_options& other) const { return !(*this == other); }
+};
+
+namespace page_detail {
+static constexpr std::size_t cache_line = 64;
+static constexpr std::size_t huge_page = std::size_t(2) << 20;
+// Smaller allocations are never mapped
+static constexpr std::size_t min_mapped = std::size_t(64) << 10;
+
+#if defined(FNV1A_MEMORY_MMAP)
+static inline std::size_t page_size()
+{
+    static const std::size_t size = std::size_t(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+// Mapped size of an allocation: does not depend on which mapping succeeded, so that deallocation finds it again
+static inline std::size_t mapped_size(std::size_t bytes, const page_options& options)
+{
+    const std::size_t unit = options.huge_pages || options.explicit_huge_pages ? huge_page : page_size();
+    return (bytes + unit - 1) & ~(unit - 1);
+}
+
+static inline void* map(std::size_t size, const page_options& options)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_POPULATE)
+    if (options.populate) {
+        flags |= MAP_POPULATE;
+    }
+#endif
+#if defined(MAP_HUGETLB)
+    if (options.explicit_huge_pages) {
+        void* const p = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) {
+            return p;
+        }
+    }
+#endif
+    if (!options.huge_pages && !options.explicit_huge_pages) {
+        void* const p = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        return p != MAP_FAILED ? p : nullptr;
+    }
+
+    // Transparent huge pages: a 2 MiB-aligned mapping, advised before its first touch
+    void* const raw = mmap(nullptr, size + huge_page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    char* const base = static_cast<char*>(raw);
+    char* const aligned = reinterpret_cast<char*>((uintptr_t(base) + huge_page - 1) & ~uintptr_t(huge_page - 1));
+    if (aligned != base) {
+        munmap(base, std::size_t(aligned - base));
+    }
+    if (aligned + size != base + size + huge_page) {
+        munmap(aligned + size, std::size_t(base + size + huge_page - (aligned + size)));
+    }
+#if defined(MADV_HUGEPAGE)
+    madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+    if (options.populate) {
+#if defined(MADV_POPULATE_WRITE)
+        if (madvise(aligned, size, MADV_POPULATE_WRITE) == 0) {
+            return aligned;
+        }
+#endif
+        for (std::size_t offset = 0; offset < size; offset += page_size()) {
+            reinterpret_cast<volatile char*>(aligned)[offset] = 0;
+        }
+    }
+    return aligned;
+}
+#endif
+} // namespace page_detail
+
+/**
+ * Standard allocator with page_options, for the tables of large hash tables
+ * @comment Allocations of at least 64 KiB are mapped with the options; the others (and all of them without options)
+ * are aligned on a cache line, so that no bucket straddles two lines.
+ */
+template<typename T>
+class page_allocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    page_allocator() = default;
+
+    explicit page_allocator(const page_options& options)
+      : _options(options)
+    {}
+
+    template<typename U>
+    page_allocator(const page_allocator<U>& other)
+      : _options(other.options())
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        const std::size_t bytes = n * sizeof(T);
+#if defined(FNV1A_MEMORY_MMAP)
+        if (mapped(bytes)) {
+            void* const p = page_detail::map(page_detail::mapped_size(bytes, _options), _options);
+            if (p == nullptr) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(p);
+        }
+#endif
+        return static_cast<T*>(::operator new(bytes, std::align_val_t(alignment)));
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        const std::size_t bytes = n * sizeof(T);
+#if defined(FNV1A_MEMORY_MMAP)
+        if (mapped(bytes)) {
+            munmap(p, page_detail::mapped_size(bytes, _options));
+            return;
+        }
+#endif
+        ::operator delete(p, std::align_val_t(alignment));
+    }
+
+    const page_options& options() const { return _options; }
+
+    template<typename U>
+    bool operator==(const page_allocator<U>& other) const
+    {
+        return _options == other.options();
+    }
+    template<typename U>
+    bool operator!=(const page_allocator<U>& other) const
+    {
+        return _options != other.options();
+    }
+
+private:
+    static constexpr std::size_t alignment =
+      alignof(T) > page_detail::cache_line ? alignof(T) : page_detail::cache_line;
+
+    bool mapped(std::size_t bytes) const { return _options.any() && bytes >= page_detail::min_mapped; }
+
+    page_options _options;
+};
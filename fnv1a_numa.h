@@ -0,0 +1,201 @@
+/**
+ * NUMA-replicated read-only tables: one copy per memory node, each thread reading the copy of its own node.
+ * @comment Each replica is copied by a thread whose memory policy prefers the target node, so that the pages of the
+ * copy (including those of its std::vector members) are allocated on that node when first touched. Threads resolve
+ * their node once, from the CPU they run on, and keep it in a thread-local variable shared by all tables: threads are
+ * expected to be pinned, or at least to stay on their node. Nodes are found through libnuma when FNV1A_LIBNUMA is
+ * defined (link with -lnuma), otherwise through /sys/devices/system/node and the getcpu()/set_mempolicy() system
+ * calls. Single-node hosts (and non-Linux systems) keep a single copy.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(FNV1A_LIBNUMA)
+#include <numa.h>
+#include <sched.h>
+#endif
+#endif
+
+namespace numa_detail {
+#if defined(__linux__)
+// Node list, such as "0-1,3", as in /sys/devices/system/node/online
+static inline std::vector<int> parse_nodes(const std::string& list)
+{
+    std::vector<int> nodes;
+    for (std::size_t start = 0; start < list.size();) {
+        std::size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        const std::string range = list.substr(start, end - start);
+        const std::size_t dash = range.find('-');
+        const int first = std::atoi(range.c_str());
+        const int last = dash != std::string::npos ? std::atoi(range.c_str() + dash + 1) : first;
+        for (int node = first; node <= last; node++) {
+            nodes.push_back(node);
+        }
+        start = end + 1;
+    }
+    return nodes;
+}
+#endif
+
+// Online memory nodes (at least one)
+static inline std::vector<int> online_nodes()
+{
+    std::vector<int> nodes;
+#if defined(__linux__)
+#if defined(FNV1A_LIBNUMA)
+    if (numa_available() >= 0) {
+        for (int node = 0; node <= numa_max_node(); node++) {
+            if (numa_bitmask_isbitset(numa_all_nodes_ptr, unsigned(node))) {
+                nodes.push_back(node);
+            }
+        }
+    }
+#endif
+    if (nodes.empty()) {
+        std::ifstream file("/sys/devices/system/node/online");
+        std::string list;
+        if (std::getline(file, list)) {
+            nodes = parse_nodes(list);
+        }
+    }
+#endif
+    if (nodes.empty()) {
+        nodes.push_back(0);
+    }
+    return nodes;
+}
+
+// Node of the CPU running the calling thread
+static inline int current_node()
+{
+#if defined(__linux__)
+#if defined(FNV1A_LIBNUMA)
+    if (numa_available() >= 0) {
+        const int cpu = sched_getcpu();
+        return cpu >= 0 ? std::max(numa_node_of_cpu(cpu), 0) : 0;
+    }
+#endif
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return int(node);
+    }
+#endif
+    return 0;
+}
+
+// Node of the calling thread, resolved on its first call: threads are expected to stay on their node
+static inline int thread_node()
+{
+    thread_local const int node = current_node();
+    return node;
+}
+
+// Prefer a node for the allocations of the calling thread (-1: back to the default policy)
+static inline void prefer_node(int node)
+{
+#if defined(__linux__)
+#if defined(FNV1A_LIBNUMA)
+    if (numa_available() >= 0) {
+        if (node >= 0) {
+            numa_set_preferred(node);
+        } else {
+            numa_set_localalloc();
+        }
+        return;
+    }
+#endif
+    constexpr std::size_t bits = 8 * sizeof(unsigned long);
+    unsigned long mask[1024 / bits] = {};
+    if (node >= 0 && std::size_t(node) < 1024) {
+        mask[std::size_t(node) / bits] = 1UL << (std::size_t(node) % bits);
+        // The kernel reads maxnode - 1 bits
+        syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, 1024 + 1);
+    } else {
+        syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+    }
+#else
+    (void) node;
+#endif
+}
+} // namespace numa_detail
+
+// A read-only table, replicated on each NUMA node
+template<typename T>
+class numa_replicated
+{
+public:
+    /**
+     * Replicate a table
+     * @comment Large allocations (mmap-backed, see also page_allocator) land on the replica node; small ones may be
+     * served by memory the allocator already holds elsewhere.
+     * @param table The table, copied on each node, or kept as the only copy on single-node hosts
+     */
+    explicit numa_replicated(T table)
+    {
+        const std::vector<int> nodes = numa_detail::online_nodes();
+        if (nodes.size() == 1) {
+            _replicas.emplace_back(new T(std::move(table)));
+            _nodes.assign(std::size_t(nodes[0]) + 1, 0);
+            return;
+        }
+        _nodes.assign(std::size_t(*std::max_element(nodes.begin(), nodes.end())) + 1, 0);
+        for (const int node : nodes) {
+            // Copied by a new thread, so that the memory policy of the caller is left unchanged
+            std::unique_ptr<T> replica;
+            std::thread([&] {
+                numa_detail::prefer_node(node);
+                replica.reset(new T(table));
+                numa_detail::prefer_node(-1);
+            }).join();
+            _nodes[std::size_t(node)] = uint32_t(_replicas.size());
+            _replicas.push_back(std::move(replica));
+        }
+    }
+
+    numa_replicated(const numa_replicated&) = delete;
+    numa_replicated& operator=(const numa_replicated&) = delete;
+
+    /**
+     * Replica of the calling thread's node
+     * @comment The node is resolved on the first call of each thread (see numa_detail::thread_node), for all tables
+     */
+    const T& local() const
+    {
+        if (_replicas.size() == 1) {
+            return *_replicas[0];
+        }
+        return on_node(numa_detail::thread_node());
+    }
+
+    // Replica of a node (the first one for unknown nodes)
+    const T& on_node(int node) const
+    {
+        return node >= 0 && std::size_t(node) < _nodes.size() ? *_replicas[_nodes[std::size_t(node)]] : *_replicas[0];
+    }
+
+    // Number of replicas (one per node)
+    std::size_t replicas() const { return _replicas.size(); }
+
+private:
+    std::vector<std::unique_ptr<T>> _replicas;
+    std::vector<uint32_t> _nodes; // Replica index, by node
+};
@@ -0,0 +1,215 @@
+/**
+ * Radix partitioning of string rows by the high bits of their finalized Fnv1-a hash, for parallel joins and
+ * aggregations.
+ * @comment Two passes: a histogram of the partitions, then a scatter of (hash, row) pairs into partition-contiguous
+ * storage. Scattering row by row into thousands of partitions misses the TLB on nearly every write; rows are staged
+ * instead in one cache line per partition (software write-combining), flushed a full line at a time with streaming
+ * stores. Each thread partitions a contiguous chunk into its own region of every partition, so the output is stable
+ * and does not depend on the number of threads.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "fnv1a_column.h"
+#include "fnv1a_index.h"
+
+// A partitioned row
+struct hashed_row
+{
+    uint64_t hash;
+    uint64_t row;
+};
+
+class radix_partitioner
+{
+public:
+    // Rows staged per partition: a cache line
+    static constexpr std::size_t line = 64 / sizeof(hashed_row);
+
+    // Partition count up to which rows are scattered directly
+    static constexpr std::size_t direct = 32;
+
+    /**
+     * Create a partitioner
+     * @param bits The number of high bits of the finalized hash used (2^bits partitions, 1 to 20)
+     */
+    explicit radix_partitioner(unsigned bits)
+      : _bits(std::min(std::max(bits, 1u), 20u))
+    {}
+
+    /**
+     * Partition the rows of a column, hashed with fnv1a64
+     * @param column The column, of 32-bit (string_column) or 64-bit (large_string_column) offsets
+     * @param threads The number of threads
+     */
+    template<typename Offset>
+    void partition(const basic_string_column<Offset>& column, unsigned threads = 1)
+    {
+        std::vector<uint64_t> hashes(column.rows);
+        threads = chunks(column.rows, threads);
+        run(threads, [&](unsigned t) {
+            const std::size_t first = chunk(column.rows, threads, t);
+            hash_column<64>(column, first, chunk(column.rows, threads, t + 1) - first, hashes.data() + first);
+        });
+        partition(hashes.data(), column.rows, threads);
+    }
+
+    /**
+     * Partition rows by hash
+     * @param hashes The fnv1a64 hash of each row
+     * @param rows The number of rows
+     * @param threads The number of threads
+     */
+    void partition(const uint64_t* hashes, std::size_t rows, unsigned threads = 1)
+    {
+        const std::size_t count = partitions();
+        threads = chunks(rows, threads);
+
+        // Pass 1: histograms
+        std::vector<std::vector<std::size_t>> histograms(threads, std::vector<std::size_t>(count, 0));
+        run(threads, [&](unsigned t) {
+            std::size_t* const histogram = histograms[t].data();
+            for (std::size_t i = chunk(rows, threads, t); i < chunk(rows, threads, t + 1); i++) {
+                histogram[partition_of(hashes[i])]++;
+            }
+        });
+
+        // Partition bounds; each thread writes after the previous threads within a partition
+        _bounds.assign(count + 1, 0);
+        std::vector<std::vector<std::size_t>> starts(threads, std::vector<std::size_t>(count));
+        for (std::size_t p = 0, offset = 0; p < count; p++) {
+            _bounds[p] = offset;
+            for (unsigned t = 0; t < threads; t++) {
+                starts[t][p] = offset;
+                offset += histograms[t][p];
+            }
+        }
+        _bounds[count] = rows;
+
+        // Pass 2: scatter, 64-byte aligned output so that flushed lines are aligned
+        _storage.resize(rows + line);
+        _rows = _storage.data();
+        while (reinterpret_cast<uintptr_t>(_rows) % 64 != 0) {
+            _rows++;
+        }
+        run(threads,
+            [&](unsigned t) { scatter(hashes, chunk(rows, threads, t), chunk(rows, threads, t + 1), starts[t]); });
+    }
+
+    // Number of partitions
+    std::size_t partitions() const { return std::size_t(1) << _bits; }
+
+    // Partition of a hash: the raw high bits, which the last bytes only reach through carries, would skew partitions
+    std::size_t partition_of(uint64_t hash) const { return fnv1a_index::mixed(hash, _bits); }
+
+    // Rows of a partition
+    const hashed_row* begin(std::size_t p) const { return _rows + _bounds[p]; }
+    const hashed_row* end(std::size_t p) const { return _rows + _bounds[p + 1]; }
+
+private:
+    // At least 64K rows per thread
+    static unsigned chunks(std::size_t rows, unsigned threads)
+    {
+        return unsigned(std::max<std::size_t>(1, std::min<std::size_t>(threads, rows >> 16)));
+    }
+
+    static std::size_t chunk(std::size_t rows, unsigned threads, unsigned t) { return rows * t / threads; }
+
+    template<typename F>
+    static void run(unsigned threads, F&& fun)
+    {
+        if (threads == 1) {
+            fun(0);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back(fun, t);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Write a full, aligned line
+    static void flush(hashed_row* to, const hashed_row* from)
+    {
+#if defined(__AVX512F__)
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(to), _mm512_load_si512(from));
+#elif defined(__AVX__)
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(to), _mm256_load_si256(reinterpret_cast<const __m256i*>(from)));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(to) + 1,
+                            _mm256_load_si256(reinterpret_cast<const __m256i*>(from) + 1));
+#else
+        std::memcpy(to, from, line * sizeof(hashed_row));
+#endif
+    }
+
+    void scatter(const uint64_t* hashes, std::size_t first, std::size_t last, const std::vector<std::size_t>& starts)
+    {
+        const std::size_t count = partitions();
+        std::vector<std::size_t> next(starts);
+        hashed_row* const out = _rows;
+
+        // Few partitions: the write streams fit in the cache and the TLB, staging would only add copies
+        if (count <= direct) {
+            for (std::size_t i = first; i < last; i++) {
+                out[next[partition_of(hashes[i])]++] = hashed_row{ hashes[i], i };
+            }
+            return;
+        }
+
+        // Staging lines mirror the output alignment: slot i of a line goes to an output position equal to i modulo
+        // the line size, so that a full line is flushed to an aligned address
+        struct alignas(64) staging
+        {
+            hashed_row rows[line];
+        };
+        std::vector<staging> lines(count);
+        for (std::size_t i = first; i < last; i++) {
+            const uint64_t h = hashes[i];
+            const std::size_t p = partition_of(h);
+            const std::size_t position = next[p]++;
+            const std::size_t slot = position % line;
+            lines[p].rows[slot] = hashed_row{ h, i };
+            if (slot == line - 1) {
+                const std::size_t from = position + 1 - line;
+                if (from >= starts[p]) {
+                    flush(out + from, lines[p].rows);
+                } else {
+                    // First line of this region: the previous slots belong to the previous region
+                    std::memcpy(out + starts[p],
+                                &lines[p].rows[starts[p] % line],
+                                (position + 1 - starts[p]) * sizeof(hashed_row));
+                }
+            }
+        }
+
+        // Partial last lines
+        for (std::size_t p = 0; p < count; p++) {
+            const std::size_t from = std::max(starts[p], next[p] - next[p] % line);
+            if (from < next[p]) {
+                std::memcpy(out + from, &lines[p].rows[from % line], (next[p] - from) * sizeof(hashed_row));
+            }
+        }
+#if defined(__SSE2__)
+        _mm_sfence();
+#endif
+    }
+
+    unsigned _bits;
+    std::vector<hashed_row> _storage;
+    hashed_row* _rows = nullptr;      // 64-byte aligned, in _storage
+    std::vector<std::size_t> _bounds; // Partition bounds in _rows
+};
@@ -0,0 +1,68 @@
+/**
+ * Relocation-free constant string tables: one blob of bytes plus 32-bit offsets.
+ * @comment A constexpr table of pointers (const char*, std::string_view) needs one dynamic relocation per entry in a
+ * position-independent executable or a shared library, applied by the loader at startup, and its page is copied for
+ * each process. A static_string_pool only holds values: it lands in .rodata, shared and ready at once. Dispatchers can
+ * return an index into a pool instead of a string pointer (see dispatch_1000_index() in main.cpp).
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Compile-time string pool, see make_string_pool
+template<std::size_t Count, std::size_t Bytes>
+struct static_string_pool
+{
+    std::array<uint32_t, Count + 1> offsets; // String offsets in blob, plus the final size
+    std::array<char, Bytes> blob;
+
+    // String of an index (< size())
+    constexpr std::string_view operator[](std::size_t index) const
+    {
+        return std::string_view(blob.data() + offsets[index], offsets[index + 1] - offsets[index]);
+    }
+
+    // Number of strings
+    static constexpr std::size_t size() { return Count; }
+
+    // Memory footprint, in bytes
+    static constexpr std::size_t memory() { return sizeof(static_string_pool); }
+};
+
+// Blob size for a string list, to be passed to make_string_pool
+template<std::size_t Count>
+constexpr std::size_t string_pool_size(const std::array<std::string_view, Count>& strings)
+{
+    std::size_t size = 0;
+    for (const auto& s : strings) {
+        size += s.size();
+    }
+    return size;
+}
+
+/**
+ * Build a string pool at compile time
+ * @comment constexpr auto pool = make_string_pool<string_pool_size(strings)>(strings);
+ * The strings array is only used at compile time, and is not emitted.
+ * @param strings The strings
+ * @param order The string order: pool[i] is strings[order[i]] (identity if null)
+ */
+template<std::size_t Bytes, std::size_t Count>
+constexpr static_string_pool<Count, Bytes> make_string_pool(const std::array<std::string_view, Count>& strings,
+                                                            const uint32_t* order = nullptr)
+{
+    static_string_pool<Count, Bytes> pool = {};
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < Count; i++) {
+        pool.offsets[i] = uint32_t(offset);
+        for (const char c : strings[order != nullptr ? order[i] : i]) {
+            pool.blob[offset++] = c;
+        }
+    }
+    pool.offsets[Count] = uint32_t(offset);
+    return pool;
+}
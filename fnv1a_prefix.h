@@ -0,0 +1,173 @@
+/**
+ * Longest-prefix match over a set of registered prefixes, using incremental Fnv1-a hashing.
+ * @comment Fnv1-a is incremental: hashing the input once yields the hash of each of its prefixes. The input is hashed
+ * byte by byte, and the table is only probed at the lengths of the registered prefixes. Candidates are verified
+ * against the registered prefix, longest first.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fnv1a_index.h"
+#include "switch_fnv1a.h"
+
+template<typename Value>
+class prefix_matcher
+{
+public:
+    using hasher = fnv1a64;
+
+    // A match
+    struct match
+    {
+        const Value* value;  // nullptr if no registered prefix matched
+        std::size_t length;  // The matched prefix length
+    };
+
+    explicit prefix_matcher(std::size_t capacity = 16) { rehash(capacity); }
+
+    /**
+     * Register a prefix, unless it is already registered
+     * @param prefix The prefix
+     * @param value The associated value
+     * @return true if the prefix was registered
+     */
+    bool insert(std::string_view prefix, const Value& value)
+    {
+        const hasher::Type h = hasher::hash(prefix);
+        if (find(h, prefix) != nullptr) {
+            return false;
+        }
+        if ((_entries.size() + 1) * 2 > _slots.size()) {
+            rehash(_slots.size() * 2);
+        }
+        _entries.push_back(entry{ h, _blob.size(), prefix.size(), value });
+        _blob.append(prefix);
+        if (prefix.size() >= _lengths.size()) {
+            _lengths.resize(prefix.size() + 1, 0);
+        }
+        _lengths[prefix.size()] = 1;
+        place(h, _entries.size());
+        return true;
+    }
+
+    /**
+     * Find the longest registered prefix of a string
+     * @param s The string
+     * @return The match, whose value is nullptr if no registered prefix matched
+     */
+    match longest(std::string_view s) const
+    {
+        // Candidates (entry indexes), by increasing length
+        uint32_t candidates[64];
+        std::size_t count = 0;
+
+        // The empty prefix
+        hasher::Type h = fnv1a_traits<64>::Offset;
+        const std::size_t max = std::min(s.size(), _lengths.size() - 1);
+        if (_lengths[0]) {
+            probe(h, 0, candidates, count);
+        }
+        for (std::size_t j = 0; j < max; j++) {
+            h ^= uint8_t(s[j]);
+            h *= fnv1a_traits<64>::Prime;
+            if (_lengths[j + 1]) {
+                probe(h, j + 1, candidates, count);
+            }
+        }
+
+        // Verify, longest first
+        while (count != 0) {
+            const entry& e = _entries[candidates[--count]];
+            if (std::memcmp(_blob.data() + e.offset, s.data(), e.length) == 0) {
+                return match{ &e.value, e.length };
+            }
+        }
+        return match{ nullptr, 0 };
+    }
+
+    std::size_t size() const { return _entries.size(); }
+
+private:
+    struct entry
+    {
+        hasher::Type hash;
+        std::size_t offset; // In _blob
+        std::size_t length;
+        Value value;
+    };
+
+    struct slot
+    {
+        uint32_t tag;   // Low hash bits, to avoid touching the entry on most mismatches
+        uint32_t entry; // 1-based index in _entries, 0 if empty
+    };
+
+    std::size_t index(hasher::Type h) const { return fnv1a_index::fibonacci(h, _bits); }
+
+    // Exact lookup
+    const entry* find(hasher::Type h, std::string_view prefix) const
+    {
+        for (std::size_t i = index(h); _slots[i].entry != 0; i = (i + 1) & _mask) {
+            const entry& e = _entries[_slots[i].entry - 1];
+            if (e.hash == h && e.length == prefix.size()
+                && std::memcmp(_blob.data() + e.offset, prefix.data(), e.length) == 0) {
+                return &e;
+            }
+        }
+        return nullptr;
+    }
+
+    // Record the entries of a given length whose hash matches (usually at most one)
+    void probe(hasher::Type h, std::size_t length, uint32_t* candidates, std::size_t& count) const
+    {
+        for (std::size_t i = index(h); _slots[i].entry != 0; i = (i + 1) & _mask) {
+            const uint32_t candidate = _slots[i].entry - 1;
+            if (_slots[i].tag == uint32_t(h) && _entries[candidate].hash == h && _entries[candidate].length == length) {
+                // Keep the longest candidates when overflowing
+                if (count == 64) {
+                    std::memmove(candidates, candidates + 1, (count - 1) * sizeof(*candidates));
+                    count--;
+                }
+                candidates[count++] = candidate;
+            }
+        }
+    }
+
+    void place(hasher::Type h, std::size_t entry)
+    {
+        std::size_t i = index(h);
+        while (_slots[i].entry != 0) {
+            i = (i + 1) & _mask;
+        }
+        _slots[i] = slot{ uint32_t(h), uint32_t(entry) };
+    }
+
+    void rehash(std::size_t capacity)
+    {
+        std::size_t bits = 4;
+        while ((std::size_t(1) << bits) < capacity) {
+            bits++;
+        }
+        _slots.assign(std::size_t(1) << bits, slot{ 0, 0 });
+        _mask = _slots.size() - 1;
+        _bits = bits;
+        for (std::size_t i = 0; i < _entries.size(); i++) {
+            place(_entries[i].hash, i + 1);
+        }
+    }
+
+    std::vector<slot> _slots;
+    std::vector<entry> _entries;
+    std::string _blob;                     // Registered prefixes
+    std::vector<uint8_t> _lengths = { 0 }; // Registered prefix lengths (flags)
+    std::size_t _mask = 0;
+    unsigned _bits = 0;
+};
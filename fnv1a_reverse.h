@@ -0,0 +1,169 @@
+/**
+ * Compile-time reverse lookup table: from an Fnv1-a hash back to its string.
+ * @comment The table is a constexpr object: hashes, sorted, then the names in the same order as a static_string_pool
+ * (one blob with 32-bit offsets). It only holds values, no pointers, so it lands in .rodata without any dynamic
+ * relocation. The hashes are sorted by the Fibonacci hash of their (folded) value, and a directory on its high bits
+ * gives the first entry of each bucket: a lookup scans about one entry.
+ * A WORD("...") list can be turned into a constexpr array with constexpr lambdas (C++17):
+ *   constexpr std::size_t count = [] { std::size_t n = 0;
+ *   #define WORD(W) n++
+ *   #include "include/words-extract.h"
+ *   #undef WORD
+ *     return n; }();
+ *   constexpr auto names = [] { std::array<std::string_view, count> a{}; std::size_t n = 0;
+ *   #define WORD(W) a[n++] = W
+ *   #include "include/words-extract.h"
+ *   #undef WORD
+ *     return a; }();
+ *   constexpr auto table = make_reverse_table<reverse_table_size(names)>(names);
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "fnv1a_index.h"
+#include "fnv1a_pool.h"
+#include "switch_fnv1a.h"
+
+namespace reverse_detail {
+// Sort key: the hash folded to 64 bits, times 2^64 / golden ratio, whose high bits index the directory (see
+// fnv1a_index::fibonacci)
+template<typename T>
+static constexpr uint64_t key(T h)
+{
+    if constexpr (sizeof(T) > sizeof(uint64_t)) {
+        return fnv1a_index::fold(h) * fnv1a_index::golden;
+    } else {
+        return uint64_t(h) * fnv1a_index::golden;
+    }
+}
+
+// Directory bits: about one entry per bucket
+static constexpr unsigned directory_bits(std::size_t count)
+{
+    unsigned bits = 1;
+    while ((std::size_t(1) << bits) < count) {
+        bits++;
+    }
+    return bits;
+}
+} // namespace reverse_detail
+
+// Compile-time reverse table, see make_reverse_table
+template<std::size_t Count, std::size_t Bytes, std::size_t Bits = 128>
+struct static_reverse_table
+{
+    static_assert(Bits == 64 || Bits == 128, "64 or 128-bit hashes only");
+    using Type = typename fnv1a<Bits>::Type;
+
+    static constexpr unsigned bits = reverse_detail::directory_bits(Count);
+
+    std::array<Type, Count> hashes;                               // Sorted by reverse_detail::key()
+    std::array<uint32_t, (std::size_t(1) << bits) + 1> directory; // First entry of each bucket, plus the count
+    static_string_pool<Count, Bytes> names;                       // In the hashes order
+
+    /**
+     * Name of a hash
+     * @param h The hash
+     * @return The name, or an empty string if unknown
+     */
+    constexpr std::string_view name_of(Type h) const
+    {
+        const std::size_t d = std::size_t(reverse_detail::key(h) >> (64 - bits));
+        for (std::size_t i = directory[d]; i < directory[d + 1]; i++) {
+            if (hashes[i] == h) {
+                return names[i];
+            }
+        }
+        return std::string_view();
+    }
+
+    // Whether a hash is known
+    constexpr bool contains(Type h) const
+    {
+        const std::size_t d = std::size_t(reverse_detail::key(h) >> (64 - bits));
+        for (std::size_t i = directory[d]; i < directory[d + 1]; i++) {
+            if (hashes[i] == h) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Number of names
+    static constexpr std::size_t size() { return Count; }
+
+    // Memory footprint, in bytes
+    static constexpr std::size_t memory() { return sizeof(static_reverse_table); }
+};
+
+// Blob size for a name list, to be passed to make_reverse_table
+template<std::size_t Count>
+constexpr std::size_t reverse_table_size(const std::array<std::string_view, Count>& names)
+{
+    return string_pool_size(names);
+}
+
+/**
+ * Build a reverse table at compile time
+ * @comment constexpr auto table = make_reverse_table<reverse_table_size(names)>(names);
+ * @param names The names
+ */
+template<std::size_t Bytes, std::size_t Bits = 128, std::size_t Count>
+constexpr static_reverse_table<Count, Bytes, Bits> make_reverse_table(const std::array<std::string_view, Count>& names)
+{
+    using table_t = static_reverse_table<Count, Bytes, Bits>;
+    table_t table = {};
+
+    // Heap sort of the name indexes by key: O(n log n) steps, as constexpr evaluation is slow
+    std::array<typename table_t::Type, Count> hashes = {};
+    std::array<uint32_t, Count> order = {};
+    for (std::size_t i = 0; i < Count; i++) {
+        hashes[i] = fnv1a<Bits>::hash(names[i].data(), names[i].size());
+        order[i] = uint32_t(i);
+    }
+    const auto less = [&](uint32_t a, uint32_t b) {
+        return reverse_detail::key(hashes[a]) < reverse_detail::key(hashes[b]);
+    };
+    const auto sift = [&](std::size_t root, std::size_t end) {
+        for (std::size_t child = 2 * root + 1; child < end; child = 2 * root + 1) {
+            if (child + 1 < end && less(order[child], order[child + 1])) {
+                child++;
+            }
+            if (!less(order[root], order[child])) {
+                break;
+            }
+            const uint32_t swap = order[root];
+            order[root] = order[child];
+            order[child] = swap;
+            root = child;
+        }
+    };
+    for (std::size_t i = Count / 2; i-- != 0;) {
+        sift(i, Count);
+    }
+    for (std::size_t end = Count; end > 1; end--) {
+        const uint32_t swap = order[0];
+        order[0] = order[end - 1];
+        order[end - 1] = swap;
+        sift(0, end - 1);
+    }
+
+    for (std::size_t i = 0; i < Count; i++) {
+        table.hashes[i] = hashes[order[i]];
+    }
+    table.names = make_string_pool<Bytes>(names, order.data());
+
+    std::size_t entry = 0;
+    for (std::size_t d = 0; d < table.directory.size(); d++) {
+        while (entry < Count && (reverse_detail::key(table.hashes[entry]) >> (64 - table_t::bits)) < d) {
+            entry++;
+        }
+        table.directory[d] = uint32_t(entry);
+    }
+    return table;
+}
@@ -0,0 +1,134 @@
+/**
+ * Runtime table for very long keys (URLs, user agents...), indexed by a sampled Fnv1-a hash.
+ * @comment Only the prefix, suffix and length of the keys are hashed (see fnv1a::hash_sampled); every match is verified
+ * against the full key.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "fnv1a_index.h"
+#include "switch_fnv1a.h"
+
+/**
+ * Sampled-hash map
+ * @comment With the default sampling, the hashes of hash() are those of the "..."_fnv1a64_sampled literals: keys can be
+ * dispatched with a switch on hash(key), or looked up with find(key, "..."_fnv1a64_sampled).
+ */
+template<typename Value, std::size_t Prefix = 32, std::size_t Suffix = 32, std::size_t Stride = 0>
+class sampled_map
+{
+public:
+    using hasher = fnv1a64;
+
+    /**
+     * Hash a key the way the table does
+     * @param key The key
+     * @return The sampled hash
+     */
+    static constexpr hasher::Type hash(std::string_view key)
+    {
+        return hasher::hash_sampled<Prefix, Suffix, Stride>(key.data(), key.size());
+    }
+
+    explicit sampled_map(std::size_t capacity = 16) { rehash(capacity); }
+
+    /**
+     * Insert a key, unless it is already present
+     * @param key The key
+     * @param value The value
+     * @return true if the key was inserted
+     */
+    bool insert(std::string_view key, const Value& value)
+    {
+        const hasher::Type h = hash(key);
+        if (find(key, h) != nullptr) {
+            return false;
+        }
+        if ((_entries.size() + 1) * 2 > _slots.size()) {
+            rehash(_slots.size() * 2);
+        }
+        _entries.emplace_back(std::string(key), value);
+        place(h, _entries.size());
+        return true;
+    }
+
+    /**
+     * Find a key
+     * @param key The key
+     * @return The value, or nullptr if the key is not present
+     */
+    const Value* find(std::string_view key) const { return find(key, hash(key)); }
+
+    /**
+     * Find a key whose sampled hash was already computed
+     * @param key The key, verified against the candidates
+     * @param h The key hash, as returned by hash()
+     * @return The value, or nullptr if the key is not present
+     */
+    const Value* find(std::string_view key, hasher::Type h) const
+    {
+        for (std::size_t i = index(h);; i = (i + 1) & _mask) {
+            const slot& s = _slots[i];
+            if (s.entry == 0) {
+                return nullptr;
+            }
+
+            // Mandatory full-string verification: samples may collide
+            if (s.hash == h) {
+                const auto& entry = _entries[s.entry - 1];
+                if (entry.first.size() == key.size() && std::memcmp(entry.first.data(), key.data(), key.size()) == 0) {
+                    return &entry.second;
+                }
+            }
+        }
+    }
+
+    std::size_t size() const { return _entries.size(); }
+
+private:
+    struct slot
+    {
+        hasher::Type hash;
+        std::size_t entry; // 1-based index in _entries, 0 if empty
+    };
+
+    std::size_t index(hasher::Type h) const { return fnv1a_index::fibonacci(h, _bits); }
+
+    void place(hasher::Type h, std::size_t entry)
+    {
+        std::size_t i = index(h);
+        while (_slots[i].entry != 0) {
+            i = (i + 1) & _mask;
+        }
+        _slots[i] = { h, entry };
+    }
+
+    void rehash(std::size_t capacity)
+    {
+        std::size_t bits = 4;
+        while ((std::size_t(1) << bits) < capacity) {
+            bits++;
+        }
+        _slots.assign(std::size_t(1) << bits, slot{ 0, 0 });
+        _mask = _slots.size() - 1;
+        _bits = bits;
+        for (std::size_t i = 0; i < _entries.size(); i++) {
+            place(hash(_entries[i].first), i + 1);
+        }
+    }
+
+    std::vector<slot> _slots;
+    std::vector<std::pair<std::string, Value>> _entries;
+    std::size_t _mask = 0;
+    unsigned _bits = 0;
+};
+
+static_assert(sampled_map<int>::hash("hello") == "hello"_fnv1a64_sampled);
@@ -0,0 +1,319 @@
+/**
+ * Multi-keyword substring search over large texts (Rabin–Karp over Fnv1-a hashes of fixed-width windows).
+ * @comment Every pattern is represented by its window, ie. its first 'width' bytes; patterns shorter than that are
+ * represented by every window they start. The window of each text position is hashed with fnv1a32: Fnv1-a does not
+ * roll, but hashing a 4-byte window again costs no more than rolling it. Hashes are tested against a bit filter, 64
+ * positions at a time and without branches (most positions are rejected, unpredictably), and the rare candidates are
+ * looked up in the window table, indexed by the same hash, then verified. Patterns of one or two bytes, which match
+ * too many windows to be expanded, are filtered separately, on the first two bytes of each position.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "fnv1a_index.h"
+#include "switch_fnv1a.h"
+
+class keyword_searcher
+{
+public:
+    // Window width, in bytes
+    static constexpr std::size_t width = 4;
+
+    /**
+     * Register a pattern
+     * @comment build() must be called once all patterns are registered
+     * @param pattern The pattern (not empty)
+     * @return The pattern index, reported by search()
+     */
+    std::size_t add(std::string_view pattern)
+    {
+        _patterns.push_back(pattern_ref{ _blob.size(), pattern.size() });
+        _blob.append(pattern);
+        return _patterns.size() - 1;
+    }
+
+    // Build the search tables
+    void build()
+    {
+        // (window, pattern), sorted so that identical windows are contiguous
+        std::vector<std::pair<uint32_t, uint32_t>> windows;
+        _tiny.clear();
+        _short.assign(65536 / 64, 0);
+        for (std::size_t i = 0; i < _patterns.size(); i++) {
+            const pattern_ref& p = _patterns[i];
+            const uint32_t head = uint32_t(load(_blob.data() + p.offset, std::min(p.length, width)));
+            if (p.length >= width) {
+                windows.emplace_back(head, uint32_t(i));
+            } else if (p.length == width - 1) {
+                // Any fourth byte (zero past the end of the text)
+                for (uint32_t c = 0; c < 256; c++) {
+                    windows.emplace_back(head | c << 24, uint32_t(i));
+                }
+            } else if (p.length != 0) {
+                _tiny.push_back(uint32_t(i));
+                for (uint32_t c = 0; c < (p.length == 1 ? 256 : 1); c++) {
+                    set(_short, head | c << 8);
+                }
+            }
+        }
+        std::sort(windows.begin(), windows.end());
+
+        // Filter with ~64 bits per window (~1.5% false positives), table at most half full
+        std::size_t distinct = 0;
+        for (std::size_t i = 0; i < windows.size(); i++) {
+            distinct += i == 0 || windows[i].first != windows[i - 1].first;
+        }
+        _filter_bits = 10;
+        while ((std::size_t(1) << _filter_bits) < distinct * 64 && _filter_bits < 24) {
+            _filter_bits++;
+        }
+        _filter.assign((std::size_t(1) << _filter_bits) / 64, 0);
+        _bucket_bits = 4;
+        while ((std::size_t(1) << _bucket_bits) < distinct * 2) {
+            _bucket_bits++;
+        }
+        _buckets.assign(std::size_t(1) << _bucket_bits, bucket{ 0, 0, 0 });
+
+        _entries.clear();
+        for (std::size_t i = 0; i < windows.size();) {
+            const uint32_t window = windows[i].first;
+            const uint32_t begin = uint32_t(_entries.size());
+            for (; i < windows.size() && windows[i].first == window; i++) {
+                const pattern_ref& p = _patterns[windows[i].second];
+                const std::size_t head = std::min<std::size_t>(p.length, 8);
+                _entries.push_back(entry{ load(_blob.data() + p.offset, head),
+                                          head == 8 ? ~uint64_t(0) : (uint64_t(1) << (head * 8)) - 1,
+                                          windows[i].second });
+            }
+            insert(window, begin, uint32_t(_entries.size()) - begin);
+        }
+    }
+
+    /**
+     * Report every occurrence of every pattern, overlapping ones included
+     * @param text The text
+     * @param size The text size
+     * @param on_match Callback, called with (pattern index, offset) for each occurrence, by increasing 64-byte blocks
+     * of offsets (not necessarily in order within a block)
+     */
+    template<typename F>
+    void search(const char* text, std::size_t size, F&& on_match) const
+    {
+        if (_tiny.empty()) {
+            search<false>(text, size, on_match);
+        } else {
+            search<true>(text, size, on_match);
+        }
+    }
+
+    std::size_t size() const { return _patterns.size(); }
+
+    // Pattern, by index
+    std::string_view pattern(std::size_t index) const
+    {
+        return std::string_view(_blob.data() + _patterns[index].offset, _patterns[index].length);
+    }
+
+private:
+    struct pattern_ref
+    {
+        std::size_t offset; // In _blob
+        std::size_t length;
+    };
+
+    // A pattern in a bucket
+    struct entry
+    {
+        uint64_t head; // First 8 bytes (or less), little-endian
+        uint64_t mask; // Mask of the 'head' bytes
+        uint32_t id;   // Pattern index
+    };
+
+    // Patterns sharing the same window
+    struct bucket
+    {
+        uint32_t window;
+        uint32_t begin; // In _entries
+        uint32_t count; // 0 if empty
+    };
+
+    template<bool Tiny, typename F>
+    void search(const char* text, std::size_t size, F& on_match) const
+    {
+        // Positions whose 8 bytes are readable, then the zero-padded tail
+        const std::size_t body = size >= 8 ? size - 7 : 0;
+        std::size_t block = 0;
+        for (; block + 64 <= body; block += 64) {
+            uint64_t candidates = 0;
+            uint64_t tiny = 0;
+            for (std::size_t i = 0; i < 64; i++) {
+                const char* const s = text + block + i;
+                candidates |= uint64_t(test(_filter, filter_index(hash(s)))) << i;
+                if constexpr (Tiny) {
+                    tiny |= uint64_t(test(_short, load2(s))) << i;
+                }
+            }
+            verify<Tiny>(text, size, block, candidates, tiny, on_match);
+        }
+        for (; block < size; block += 64) {
+            const std::size_t count = std::min<std::size_t>(64, size - block);
+            uint64_t candidates = 0;
+            uint64_t tiny = 0;
+            for (std::size_t i = 0; i < count; i++) {
+                char padded[width] = {};
+                std::memcpy(padded, text + block + i, std::min(width, size - block - i));
+                candidates |= uint64_t(test(_filter, filter_index(hash(padded)))) << i;
+                if constexpr (Tiny) {
+                    tiny |= uint64_t(test(_short, load2(padded))) << i;
+                }
+            }
+            verify<Tiny>(text, size, block, candidates, tiny, on_match);
+        }
+    }
+
+    // Verify the candidate positions of a block
+    template<bool Tiny, typename F>
+    void verify(const char* text, std::size_t size, std::size_t block, uint64_t candidates, uint64_t tiny,
+                F& on_match) const
+    {
+        for (; candidates != 0; candidates &= candidates - 1) {
+            const std::size_t pos = block + __builtin_ctzll(candidates);
+            const std::size_t avail = size - pos;
+            const uint64_t word = avail >= 8 ? load8(text + pos) : load(text + pos, avail);
+            const bucket* const b = find(uint32_t(word));
+            if (b != nullptr) {
+                verify(_entries.data() + b->begin, b->count, word, text + pos, avail, pos, on_match);
+            }
+        }
+        if constexpr (Tiny) {
+            for (; tiny != 0; tiny &= tiny - 1) {
+                const std::size_t pos = block + __builtin_ctzll(tiny);
+                for (const uint32_t id : _tiny) {
+                    const pattern_ref& p = _patterns[id];
+                    if (p.length <= size - pos && std::memcmp(text + pos, _blob.data() + p.offset, p.length) == 0) {
+                        on_match(std::size_t(id), pos);
+                    }
+                }
+            }
+        }
+    }
+
+    // Verify the patterns of a bucket at a text position ('avail' bytes being readable, starting with 'word')
+    template<typename F>
+    void verify(const entry* entries, uint32_t count, uint64_t word, const char* s, std::size_t avail, std::size_t pos,
+                F& on_match) const
+    {
+        for (uint32_t k = 0; k < count; k++) {
+            // First 8 bytes, then the remaining ones
+            const entry& e = entries[k];
+            if ((word & e.mask) == e.head) {
+                const pattern_ref& p = _patterns[e.id];
+                if (p.length <= avail && (p.length <= 8 || same(s + 8, _blob.data() + p.offset + 8, p.length - 8))) {
+                    on_match(std::size_t(e.id), pos);
+                }
+            }
+        }
+    }
+
+    // Hash of the window at a position
+    static uint32_t hash(const char* s) { return fnv1a32::hash(s, width); }
+
+    // Hash of a window, from its little-endian value
+    static uint32_t hash(uint32_t window)
+    {
+        uint32_t h = fnv1a_traits<32>::Offset;
+        for (std::size_t i = 0; i < width; i++) {
+            h ^= (window >> (i * 8)) & 0xff;
+            h *= fnv1a_traits<32>::Prime;
+        }
+        return h;
+    }
+
+    // Filter bit of a window hash (see fnv1a_index::fibonacci)
+    std::size_t filter_index(uint32_t h) const { return fnv1a_index::fibonacci(h, _filter_bits); }
+
+    void insert(uint32_t window, uint32_t begin, uint32_t count)
+    {
+        const uint32_t h = hash(window);
+        set(_filter, filter_index(h));
+        const std::size_t mask = _buckets.size() - 1;
+        std::size_t i = fnv1a_index::fibonacci(h, _bucket_bits);
+        while (_buckets[i].count != 0) {
+            i = (i + 1) & mask;
+        }
+        _buckets[i] = bucket{ window, begin, count };
+    }
+
+    const bucket* find(uint32_t window) const
+    {
+        const std::size_t mask = _buckets.size() - 1;
+        for (std::size_t i = fnv1a_index::fibonacci(hash(window), _bucket_bits); _buckets[i].count != 0;
+             i = (i + 1) & mask) {
+            if (_buckets[i].window == window) {
+                return &_buckets[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // Inlined comparison of short byte ranges
+    static bool same(const char* a, const char* b, std::size_t n)
+    {
+        for (; n >= 8; a += 8, b += 8, n -= 8) {
+            if (load8(a) != load8(b)) {
+                return false;
+            }
+        }
+        for (; n != 0; a++, b++, n--) {
+            if (*a != *b) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void set(std::vector<uint64_t>& bits, std::size_t i) { bits[i / 64] |= uint64_t(1) << (i % 64); }
+
+    static bool test(const std::vector<uint64_t>& bits, std::size_t i) { return (bits[i / 64] >> (i % 64)) & 1; }
+
+    // Little-endian window of 'width' bytes, zero-padded
+    static uint64_t load(const char* s, std::size_t width)
+    {
+        uint64_t window = 0;
+        for (std::size_t i = 0; i < width; i++) {
+            window |= uint64_t(uint8_t(s[i])) << (i * 8);
+        }
+        return window;
+    }
+
+    static std::size_t load2(const char* s) { return std::size_t(uint8_t(s[0])) | std::size_t(uint8_t(s[1])) << 8; }
+
+    static uint64_t load8(const char* s)
+    {
+        uint64_t window;
+        std::memcpy(&window, s, sizeof(window));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        window = __builtin_bswap64(window);
+#endif
+        return window;
+    }
+
+    std::vector<pattern_ref> _patterns;
+    std::string _blob; // Pattern bytes
+    std::vector<uint64_t> _filter; // Bit filter of the window hashes
+    unsigned _filter_bits = 0;
+    std::vector<bucket> _buckets; // Window table, indexed by the window hashes
+    unsigned _bucket_bits = 0;
+    std::vector<entry> _entries; // Patterns, by bucket
+    std::vector<uint64_t> _short; // Filter of the one and two-byte patterns, on the first two bytes of a position
+    std::vector<uint32_t> _tiny; // The one and two-byte patterns
+};
@@ -0,0 +1,259 @@
+/**
+ * Shard routing of Fnv1-a hashes: jump consistent hashing and weighted rendezvous hashing.
+ * @comment Unlike a modulo, both move only about 1/n of the keys when an n-th shard is added. Jump consistent hashing
+ * (Lamping and Veach) needs no memory and O(log n) steps per key, but shards are numbered and only the last one can be
+ * removed. Rendezvous (highest random weight) hashing scores every node for each key, in O(n), but nodes are named,
+ * weighted, and any of them can be removed. Both run the Fnv1-a hash through the fnv1a_index::mix finalizer first:
+ * the jump hash uses the high bits, that FNV barely mixes.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include "fnv1a_index.h"
+#include "switch_fnv1a.h"
+
+namespace shard_detail {
+static inline uint64_t key_of(fnv1a64::Type h)
+{
+    return fnv1a_index::mix(h);
+}
+
+static inline uint64_t key_of(fnv1a128::Type h)
+{
+    return fnv1a_index::mix(fnv1a_index::fold(h));
+}
+
+// One step of the jump: the next shard the key jumps to (from shard b)
+static inline int64_t jump(uint64_t& key, int64_t b)
+{
+    key = key * 2862933555777941757ULL + 1;
+    return int64_t(double(b + 1) * (double(int64_t(1) << 31) / double((key >> 33) + 1)));
+}
+
+static inline uint32_t jump_hash(uint64_t key, uint32_t shards)
+{
+    int64_t b = -1;
+    for (int64_t j = 0; j < int64_t(shards);) {
+        b = j;
+        j = jump(key, b);
+    }
+    return uint32_t(b);
+}
+} // namespace shard_detail
+
+/**
+ * Jump consistent hash of a hashed key
+ * @param hash The fnv1a64 or fnv1a128 hash of the key
+ * @param shards The number of shards (at least 1)
+ * @return The shard, in [0, shards)
+ */
+static inline uint32_t jump_shard(fnv1a64::Type hash, uint32_t shards)
+{
+    return shard_detail::jump_hash(shard_detail::key_of(hash), shards);
+}
+
+static inline uint32_t jump_shard(fnv1a128::Type hash, uint32_t shards)
+{
+    return shard_detail::jump_hash(shard_detail::key_of(hash), shards);
+}
+
+static inline uint32_t jump_shard(std::string_view key, uint32_t shards)
+{
+    return jump_shard(fnv1a64::hash(key), shards);
+}
+
+/**
+ * Jump consistent hash of a batch of hashed keys
+ * @comment Four keys jump in lockstep: the loop is bound by the latency of its division, which independent keys overlap
+ * @param hashes The fnv1a64 or fnv1a128 hashes
+ * @param count The number of hashes
+ * @param shards The number of shards (at least 1)
+ * @param out The shard of each hash
+ */
+template<typename H>
+static inline void jump_shard(const H* hashes, std::size_t count, uint32_t shards, uint32_t* out)
+{
+    constexpr std::size_t lanes = 4;
+    const int64_t n = int64_t(shards);
+    const std::size_t full = count - count % lanes;
+    for (std::size_t i = 0; i < full; i += lanes) {
+        uint64_t key[lanes];
+        int64_t b[lanes];
+        int64_t j[lanes];
+        for (std::size_t lane = 0; lane < lanes; lane++) {
+            key[lane] = shard_detail::key_of(hashes[i + lane]);
+            b[lane] = -1;
+            j[lane] = 0;
+        }
+        while (j[0] < n || j[1] < n || j[2] < n || j[3] < n) {
+            for (std::size_t lane = 0; lane < lanes; lane++) {
+                if (j[lane] < n) {
+                    b[lane] = j[lane];
+                    j[lane] = shard_detail::jump(key[lane], b[lane]);
+                }
+            }
+        }
+        for (std::size_t lane = 0; lane < lanes; lane++) {
+            out[i + lane] = uint32_t(b[lane]);
+        }
+    }
+    for (std::size_t i = full; i < count; i++) {
+        out[i] = jump_shard(hashes[i], shards);
+    }
+}
+
+// Weighted rendezvous hashing over named nodes
+class rendezvous_router
+{
+public:
+    // Keys scored at once by batch routing
+    static constexpr std::size_t batch = 64;
+
+    // No node to route to: no node, or no node of positive weight (uint32_t(npos) for batch routing)
+    static constexpr std::size_t npos = ~std::size_t(0);
+
+    /**
+     * Add a node
+     * @param name The node name, whose fnv1a64 hash seeds the node scores
+     * @param weight The node weight: its share of the keys is proportional to it
+     * @return The node index
+     */
+    std::size_t add(std::string_view name, double weight = 1)
+    {
+        _seeds.push_back(fnv1a_index::mix(fnv1a64::hash(name)));
+        _weights.push_back(weight);
+        update();
+        return _seeds.size() - 1;
+    }
+
+    /**
+     * Change the weight of a node
+     * @comment Only keys moving to or from this node are remapped; a zero weight removes the node (when no node has a
+     * positive weight left, keys route to npos)
+     */
+    void set_weight(std::size_t node, double weight)
+    {
+        _weights[node] = weight;
+        update();
+    }
+
+    // Number of nodes
+    std::size_t size() const { return _seeds.size(); }
+
+    /**
+     * Route a hashed key
+     * @param hash The fnv1a64 or fnv1a128 hash of the key
+     * @return The node index, of the highest score, or npos if no node has a positive weight
+     */
+    std::size_t route(fnv1a64::Type hash) const { return route_key(shard_detail::key_of(hash)); }
+
+    std::size_t route(fnv1a128::Type hash) const { return route_key(shard_detail::key_of(hash)); }
+
+    std::size_t route(std::string_view key) const { return route(fnv1a64::hash(key)); }
+
+    /**
+     * Route a batch of hashed keys
+     * @comment Nodes are the outer loop: each key batch is scored against one node at a time, in a loop free of
+     * branches that the compiler vectorizes
+     * @param hashes The fnv1a64 or fnv1a128 hashes
+     * @param count The number of hashes
+     * @param out The node index of each hash, or uint32_t(npos) if no node has a positive weight
+     */
+    template<typename H>
+    void route(const H* hashes, std::size_t count, uint32_t* out) const
+    {
+        uint64_t keys[batch];
+        for (std::size_t first = 0; first < count; first += batch) {
+            const std::size_t size = std::min(batch, count - first);
+            for (std::size_t i = 0; i < size; i++) {
+                keys[i] = shard_detail::key_of(hashes[first + i]);
+            }
+            if (_uniform) {
+                uint64_t best_score[batch] = {};
+                uint32_t best[batch];
+                std::fill(best, best + batch, uint32_t(npos));
+                for (std::size_t node = 0; node < _seeds.size(); node++) {
+                    const uint64_t seed = _seeds[node];
+                    for (std::size_t i = 0; i < size; i++) {
+                        const uint64_t s = fnv1a_index::mix(keys[i] ^ seed);
+                        best[i] = s >= best_score[i] ? uint32_t(node) : best[i];
+                        best_score[i] = std::max(best_score[i], s);
+                    }
+                }
+                std::copy(best, best + size, out + first);
+            } else {
+                double best_score[batch];
+                uint32_t best[batch];
+                std::fill(best_score, best_score + batch, -std::numeric_limits<double>::infinity());
+                std::fill(best, best + batch, uint32_t(npos));
+                for (std::size_t node = 0; node < _seeds.size(); node++) {
+                    for (std::size_t i = 0; i < size; i++) {
+                        const double s = score(keys[i], node);
+                        best[i] = s > best_score[i] ? uint32_t(node) : best[i];
+                        best_score[i] = std::max(best_score[i], s);
+                    }
+                }
+                std::copy(best, best + size, out + first);
+            }
+        }
+    }
+
+private:
+    // Node of the highest score for a finalized key
+    std::size_t route_key(uint64_t key) const
+    {
+        std::size_t best = npos;
+        if (_uniform) {
+            uint64_t best_score = 0;
+            for (std::size_t node = 0; node < _seeds.size(); node++) {
+                const uint64_t s = fnv1a_index::mix(key ^ _seeds[node]);
+                if (s >= best_score) {
+                    best_score = s;
+                    best = node;
+                }
+            }
+        } else {
+            double best_score = -std::numeric_limits<double>::infinity();
+            for (std::size_t node = 0; node < _seeds.size(); node++) {
+                const double s = score(key, node);
+                if (s > best_score) {
+                    best_score = s;
+                    best = node;
+                }
+            }
+        }
+        return best;
+    }
+
+    // Weighted score -weight / ln(u), compared as ln(u) / weight, with u uniform in (0, 1): -infinity without weight,
+    // which never wins
+    double score(uint64_t key, std::size_t node) const
+    {
+        const uint64_t s = fnv1a_index::mix(key ^ _seeds[node]);
+        const double u = (double(s >> 11) + 0.5) * (1.0 / double(uint64_t(1) << 53));
+        return std::log(u) * _inverse_weights[node];
+    }
+
+    void update()
+    {
+        _uniform = std::all_of(_weights.begin(), _weights.end(), [](double w) { return w == 1; });
+        _inverse_weights.resize(_weights.size());
+        for (std::size_t node = 0; node < _weights.size(); node++) {
+            _inverse_weights[node] =
+              _weights[node] > 0 ? 1 / _weights[node] : std::numeric_limits<double>::infinity();
+        }
+    }
+
+    std::vector<uint64_t> _seeds; // Finalized node name hashes
+    std::vector<double> _weights;
+    std::vector<double> _inverse_weights;
+    bool _uniform = true; // All weights are 1: the highest hash wins, without logarithms
+};
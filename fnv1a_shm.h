@@ -0,0 +1,379 @@
+/**
+ * String interning table shared by the processes of a host, in a shm_open() or memfd_create() segment.
+ * @comment The segment holds a header, a fixed-capacity open-addressing table, an ID table, and an arena of string
+ * records; it only contains offsets, as every process maps it at its own address. An insert first writes its record
+ * (fnv1a128 hash, ID, bytes) in the arena, then publishes it with a compare-and-swap of its table slot: readers never
+ * see a partial record, no process ever waits on another, and a process dying mid-insert only leaks its record. A
+ * slot packs the record offset with 32 high hash bits, so that probing rarely touches the arena. IDs are allocated
+ * before the compare-and-swap: two processes racing on the same new string both allocate one, and the loser's ID
+ * stays unused. Named segments persist until remove() is called.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fnv1a_index.h"
+#include "fnv1a_memory.h"
+#include "switch_fnv1a.h"
+
+class shm_intern_table
+{
+public:
+    // Invalid ID: the string is not interned, or the table is full
+    static constexpr uint32_t npos = 0xffffffff;
+
+    /**
+     * Create and map a new segment
+     * @param name The shm_open() name (such as "/labels"), or empty for an anonymous memfd, shared with child processes
+     * @param capacity The maximum number of strings
+     * @param arena The maximum total size of the strings, in bytes
+     * @param options Mapping options (see attach)
+     * @return The table, invalid() if the segment could not be created
+     */
+    static shm_intern_table create(const std::string& name,
+                                   std::size_t capacity,
+                                   std::size_t arena,
+                                   const page_options& options = page_options())
+    {
+        std::size_t slots = 16;
+        while (slots < capacity + capacity / 2) {
+            slots *= 2;
+        }
+        const std::size_t ids = capacity * sizeof(uint64_t);
+        // Each record: 16-byte hash, ID, length, bytes, padded to 8 bytes
+        arena += capacity * (sizeof(record) + 8);
+        const std::size_t size = sizeof(header) + slots * sizeof(uint64_t) + ids + arena;
+        if (size / 8 >= (uint64_t(1) << 32)) {
+            return shm_intern_table();
+        }
+
+#if defined(__linux__)
+        const int fd = name.empty() ? memfd_create("shm_intern_table", 0)
+                                    : shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+#else
+        const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+#endif
+        if (fd == -1) {
+            return shm_intern_table();
+        }
+        // A named segment that could not be initialized is removed, so that create() can be retried
+        if (ftruncate(fd, off_t(size)) != 0) {
+            close(fd);
+            if (!name.empty()) {
+                shm_unlink(name.c_str());
+            }
+            return shm_intern_table();
+        }
+        shm_intern_table table(fd, size, options);
+        if (!table.valid()) {
+            if (!name.empty()) {
+                shm_unlink(name.c_str());
+            }
+            return table;
+        }
+
+        // The segment is zero-filled: only the geometry is set, then the magic, last
+        header* const h = table._header;
+        h->slots = slots;
+        h->capacity = capacity;
+        h->ids = sizeof(header) + slots * sizeof(uint64_t);
+        h->arena = h->ids + ids;
+        h->arena_used.store(h->arena, std::memory_order_relaxed);
+        h->magic.store(magic, std::memory_order_release);
+        return table;
+    }
+
+    /**
+     * Map an existing segment, by name
+     * @comment The segment exists as soon as create() opens it, but it is only initialized once create() publishes its
+     * magic: until then, open() returns an invalid table, and can be retried.
+     * @param options Mapping options (see attach)
+     * @return The table, invalid() if the segment does not exist or is not initialized yet
+     */
+    static shm_intern_table open(const std::string& name, const page_options& options = page_options())
+    {
+        const int fd = shm_open(name.c_str(), O_RDWR, 0);
+        return fd != -1 ? attach(fd, options) : shm_intern_table();
+    }
+
+    /**
+     * Remove a named segment (shm_unlink())
+     * @comment Named segments outlive their processes until removed. Mapped tables stay valid: the memory is released
+     * once the last one is unmapped.
+     * @param name The shm_open() name, as given to create()
+     * @return true if the segment was removed
+     */
+    static bool remove(const std::string& name) { return shm_unlink(name.c_str()) == 0; }
+
+    /**
+     * Map an existing segment, by file descriptor (such as a memfd received from another process)
+     * @comment With options.populate, the whole segment is mapped at once: the first lookups do not page-fault.
+     * Shared segments can only use transparent huge pages, if /sys/kernel/mm/transparent_hugepage/shmem_enabled allows
+     * it ("advise"): options.explicit_huge_pages falls back to them.
+     * @param fd The descriptor, owned by the table from now on
+     * @param options Mapping options
+     */
+    static shm_intern_table attach(int fd, const page_options& options = page_options())
+    {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || std::size_t(st.st_size) < sizeof(header)) {
+            close(fd);
+            return shm_intern_table();
+        }
+        shm_intern_table table(fd, std::size_t(st.st_size), options);
+        if (table.valid() && table._header->magic.load(std::memory_order_acquire) != magic) {
+            return shm_intern_table();
+        }
+        return table;
+    }
+
+    shm_intern_table() = default;
+
+    shm_intern_table(shm_intern_table&& other) noexcept { *this = std::move(other); }
+
+    shm_intern_table& operator=(shm_intern_table&& other) noexcept
+    {
+        std::swap(_fd, other._fd);
+        std::swap(_base, other._base);
+        std::swap(_size, other._size);
+        std::swap(_header, other._header);
+        return *this;
+    }
+
+    ~shm_intern_table()
+    {
+        if (_base != nullptr) {
+            munmap(_base, _size);
+        }
+        if (_fd != -1) {
+            close(_fd);
+        }
+    }
+
+    bool valid() const { return _header != nullptr; }
+
+    // The segment file descriptor, to share an anonymous segment
+    int fd() const { return _fd; }
+
+    /**
+     * ID of a string, interned if new
+     * @param key The string
+     * @return The ID, shared by all processes, or npos if the table or the arena is full
+     */
+    uint32_t intern(std::string_view key) { return intern(key, fnv1a128::hash(key)); }
+
+    /**
+     * ID of a string, interned if new
+     * @param key The string
+     * @param h The key hash, as returned by fnv1a128::hash()
+     * @return The ID, shared by all processes, or npos if the table or the arena is full
+     */
+    uint32_t intern(std::string_view key, fnv1a128::Type h)
+    {
+        uint64_t created = 0; // Packed slot of our record, once written
+        std::atomic<uint64_t>* const table = slots();
+        const std::size_t mask = _header->slots - 1;
+        for (std::size_t i = index(h);; i = (i + 1) & mask) {
+            uint64_t slot = table[i].load(std::memory_order_acquire);
+            while (slot == 0) {
+                if (created == 0) {
+                    created = create(key, h);
+                    if (created == 0) {
+                        return npos;
+                    }
+                }
+                if (table[i].compare_exchange_strong(slot, created, std::memory_order_acq_rel)) {
+                    const uint32_t id = at(created).id;
+                    id_table()[id].store(created, std::memory_order_release);
+                    return id;
+                }
+                // Lost the race: slot now holds the winner, which may be the same string
+            }
+            const uint32_t id = match(slot, key, h);
+            if (id != npos) {
+                return id;
+            }
+        }
+    }
+
+    /**
+     * ID of an interned string
+     * @return The ID, or npos if the string is not interned
+     */
+    uint32_t find(std::string_view key) const { return find(key, fnv1a128::hash(key)); }
+
+    uint32_t find(std::string_view key, fnv1a128::Type h) const
+    {
+        const std::atomic<uint64_t>* const table = slots();
+        const std::size_t mask = _header->slots - 1;
+        for (std::size_t i = index(h);; i = (i + 1) & mask) {
+            const uint64_t slot = table[i].load(std::memory_order_acquire);
+            if (slot == 0) {
+                return npos;
+            }
+            const uint32_t id = match(slot, key, h);
+            if (id != npos) {
+                return id;
+            }
+        }
+    }
+
+    /**
+     * String of an ID
+     * @return The string, empty if the ID is unused
+     */
+    std::string_view name(uint32_t id) const
+    {
+        if (id >= _header->capacity) {
+            return std::string_view();
+        }
+        const uint64_t slot = id_table()[id].load(std::memory_order_acquire);
+        if (slot == 0) {
+            return std::string_view();
+        }
+        const record& r = at(slot);
+        return std::string_view(r.bytes(), r.length);
+    }
+
+    // Number of IDs allocated (an upper bound of the number of strings, at most the capacity)
+    std::size_t size() const { return _header->next_id.load(std::memory_order_relaxed); }
+
+    // Memory used by the strings, in bytes
+    std::size_t arena_used() const
+    {
+        return _header->arena_used.load(std::memory_order_relaxed) - _header->arena;
+    }
+
+private:
+    static constexpr uint64_t magic = 0x66766e31496e746eULL;
+
+    // Segment header, at offset 0
+    struct header
+    {
+        std::atomic<uint64_t> magic; // Set once the geometry is initialized
+        uint64_t slots;              // Table slots (a power of two)
+        uint64_t capacity;           // Maximum number of IDs
+        uint64_t ids;                // Offset of the ID table
+        uint64_t arena;              // Offset of the arena
+        alignas(64) std::atomic<uint64_t> arena_used; // Arena allocation offset
+        alignas(64) std::atomic<uint32_t> next_id;
+    };
+
+    // String record, in the arena, 8-byte aligned
+    struct record
+    {
+        uint64_t hash_lo;
+        uint64_t hash_hi;
+        uint32_t id;
+        uint32_t length;
+
+        const char* bytes() const { return reinterpret_cast<const char*>(this + 1); }
+        char* bytes() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "cross-process atomics must be lock-free");
+
+    shm_intern_table(int fd, std::size_t size, const page_options& options)
+      : _fd(fd)
+      , _size(size)
+    {
+        int flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+        if (options.populate) {
+            flags |= MAP_POPULATE;
+        }
+#endif
+        void* const base = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+        if (base != MAP_FAILED) {
+            _base = static_cast<char*>(base);
+            _header = reinterpret_cast<header*>(_base);
+#if defined(MADV_HUGEPAGE)
+            if (options.huge_pages || options.explicit_huge_pages) {
+                madvise(_base, size, MADV_HUGEPAGE);
+            }
+#endif
+        }
+    }
+
+    std::atomic<uint64_t>* slots() const { return reinterpret_cast<std::atomic<uint64_t>*>(_base + sizeof(header)); }
+
+    std::atomic<uint64_t>* id_table() const
+    {
+        return reinterpret_cast<std::atomic<uint64_t>*>(_base + _header->ids);
+    }
+
+    // Slot: record offset / 8 (low 32 bits), then 32 high hash bits
+    static uint32_t tag(fnv1a128::Type h) { return uint32_t(h >> 96); }
+
+    const record& at(uint64_t slot) const { return *reinterpret_cast<const record*>(_base + (slot & 0xffffffff) * 8); }
+
+    std::size_t index(fnv1a128::Type h) const
+    {
+        return fnv1a_index::fibonacci(fnv1a_index::fold(h), unsigned(__builtin_ctzll(_header->slots)));
+    }
+
+    // ID of the record of a slot if it holds the key, npos otherwise
+    uint32_t match(uint64_t slot, std::string_view key, fnv1a128::Type h) const
+    {
+        if (uint32_t(slot >> 32) != tag(h)) {
+            return npos;
+        }
+        const record& r = at(slot);
+        if (r.hash_lo == uint64_t(h) && r.hash_hi == uint64_t(h >> 64) && r.length == key.size()
+            && std::memcmp(r.bytes(), key.data(), key.size()) == 0) {
+            return r.id;
+        }
+        return npos;
+    }
+
+    /**
+     * Write a new record, and return its packed slot (0 if full)
+     * @comment The arena space is reserved first, then the ID: both counters only move forward on success, so that
+     * failed inserts neither wrap them nor leave gaps in the IDs
+     */
+    uint64_t create(std::string_view key, fnv1a128::Type h)
+    {
+        const std::size_t bytes = (sizeof(record) + key.size() + 7) & ~std::size_t(7);
+        uint64_t offset = _header->arena_used.load(std::memory_order_relaxed);
+        do {
+            if (offset + bytes > _size) {
+                return 0;
+            }
+        } while (!_header->arena_used.compare_exchange_weak(offset, offset + bytes, std::memory_order_relaxed));
+
+        uint32_t id = _header->next_id.load(std::memory_order_relaxed);
+        do {
+            if (id >= _header->capacity) {
+                // Give the arena space back, unless another record was allocated after it
+                uint64_t end = offset + bytes;
+                _header->arena_used.compare_exchange_strong(end, offset, std::memory_order_relaxed);
+                return 0;
+            }
+        } while (!_header->next_id.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+
+        record* const r = reinterpret_cast<record*>(_base + offset);
+        r->hash_lo = uint64_t(h);
+        r->hash_hi = uint64_t(h >> 64);
+        r->id = id;
+        r->length = uint32_t(key.size());
+        std::memcpy(r->bytes(), key.data(), key.size());
+        return (uint64_t(tag(h)) << 32) | (offset / 8);
+    }
+
+    int _fd = -1;
+    char* _base = nullptr;
+    std::size_t _size = 0;
+    header* _header = nullptr;
+};
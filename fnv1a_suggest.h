@@ -0,0 +1,339 @@
+/**
+ * "Did you mean" suggestions for unknown keywords (SymSpell-style deletion neighborhoods over Fnv1-a hashes).
+ * @comment Every keyword is indexed under the hashes of itself and of all its single and double deletion variants.
+ * Two strings within edit distance 2 share at least one such variant, so a query only probes the hashes of its own
+ * deletion variants, and verifies the candidates with a bounded edit distance. The index can be built at startup
+ * (keyword_suggester) or, for small sets, at compile time (make_suggest_index).
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "fnv1a_index.h"
+#include "switch_fnv1a.h"
+
+namespace suggest_detail {
+// Maximum edit distance handled by the index
+static constexpr std::size_t max_distance = 2;
+
+// Fingerprint of a string, without the characters at positions i and j (use i, j >= size to keep them)
+static constexpr uint32_t fingerprint(std::string_view s, std::size_t i, std::size_t j)
+{
+    fnv1a64::Type hash = fnv1a_traits<64>::Offset;
+    for (std::size_t k = 0; k < s.size(); k++) {
+        if (k != i && k != j) {
+            hash ^= uint8_t(s[k]);
+            hash *= fnv1a_traits<64>::Prime;
+        }
+    }
+
+    // Finalized first: the directory of keyword_suggester indexes the high fingerprint bits, which the last
+    // characters only reach through carries in a raw Fnv1-a hash
+    return uint32_t(fnv1a_index::mix(hash) >> 32);
+}
+
+// Call f(fingerprint) for the string and each of its single and double deletion variants
+template<typename F>
+static constexpr void for_each_variant(std::string_view s, F&& f)
+{
+    const std::size_t none = s.size();
+    f(fingerprint(s, none, none));
+    for (std::size_t i = 0; i < s.size(); i++) {
+        f(fingerprint(s, i, none));
+        for (std::size_t j = i + 1; j < s.size(); j++) {
+            f(fingerprint(s, i, j));
+        }
+    }
+}
+
+// Number of variants of a string
+static constexpr std::size_t variants(std::size_t size)
+{
+    return 1 + size + size * (size - (size != 0)) / 2;
+}
+
+/**
+ * Optimal string alignment distance (Levenshtein with adjacent transpositions), bounded
+ * @comment Only the diagonal band of width 2 * max + 1 is computed
+ * @param max The maximum distance (at most max_distance)
+ * @return The distance, or max + 1 if it exceeds max
+ */
+static inline std::size_t distance(std::string_view a, std::string_view b, std::size_t max)
+{
+    max = std::min(max, max_distance);
+    if ((a.size() > b.size() ? a.size() - b.size() : b.size() - a.size()) > max) {
+        return max + 1;
+    }
+
+    // Three rows: i - 2, i - 1, i (on the stack for usual keyword sizes, on the heap for longer ones); cells hold
+    // distances capped at max + 1, out-of-band ones included
+    const std::size_t out = max + 1;
+    const std::size_t width = b.size() + 1;
+    uint8_t buffer[3 * 64];
+    std::vector<uint8_t> heap;
+    uint8_t* rows = buffer;
+    if (width > 64) {
+        heap.resize(3 * width);
+        rows = heap.data();
+    }
+    uint8_t* prev2 = &rows[0];
+    uint8_t* prev = &rows[width];
+    uint8_t* row = &rows[2 * width];
+    for (std::size_t j = 0; j < width; j++) {
+        prev2[j] = out;
+        prev[j] = uint8_t(std::min(j, out));
+        row[j] = out;
+    }
+    for (std::size_t i = 1; i <= a.size(); i++) {
+        const std::size_t from = i > max ? i - max : 1;
+        const std::size_t to = std::min(b.size(), i + max);
+        if (from > 1) {
+            row[from - 1] = out;
+        }
+        row[0] = uint8_t(std::min(i, out));
+        std::size_t best = from == 1 ? row[0] : out;
+        for (std::size_t j = from; j <= to; j++) {
+            const std::size_t cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            std::size_t d = std::min({ std::size_t(prev[j]) + 1, std::size_t(row[j - 1]) + 1, prev[j - 1] + cost });
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+                d = std::min(d, std::size_t(prev2[j - 2]) + 1);
+            }
+            row[j] = uint8_t(std::min(d, out));
+            best = std::min(best, d);
+        }
+        if (to < b.size()) {
+            row[to + 1] = out;
+        }
+        if (best > max) {
+            return out;
+        }
+        uint8_t* const recycled = prev2;
+        prev2 = prev;
+        prev = row;
+        row = recycled;
+    }
+    return prev[b.size()];
+}
+
+// A suggestion
+struct suggestion
+{
+    std::size_t index;    // Keyword index
+    std::size_t distance; // Edit distance to the query
+};
+
+/**
+ * Look up the keywords within 'max' edits of a query
+ * @param query The query
+ * @param max The maximum distance (at most max_distance)
+ * @param k The maximum number of suggestions
+ * @param candidates Function called with (fingerprints, callback), calling callback(index) for each keyword indexed
+ * under one of the fingerprints
+ * @param word Function returning the keyword at an index
+ * @return The best suggestions, by increasing distance, then index
+ */
+template<typename C, typename W>
+static std::vector<suggestion> lookup(std::string_view query, std::size_t max, std::size_t k, C&& candidates, W&& word)
+{
+    max = std::min(max, max_distance);
+
+    // Candidates, once each: a keyword usually shares several variants with the query
+    std::vector<uint32_t> fps;
+    fps.reserve(variants(query.size()));
+    for_each_variant(query, [&](uint32_t fp) { fps.push_back(fp); });
+    std::vector<std::size_t> indexes;
+    candidates(fps, [&](std::size_t index) { indexes.push_back(index); });
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+
+    // Verify, the bound shrinking as soon as k suggestions are known at a given distance
+    std::vector<suggestion> found;
+    std::size_t counts[max_distance + 1] = {};
+    std::size_t bound = max;
+    for (const std::size_t index : indexes) {
+        const std::size_t d = distance(query, word(index), bound);
+        if (d <= bound) {
+            found.push_back(suggestion{ index, d });
+            counts[d]++;
+            for (std::size_t total = 0, i = 0; i < bound; i++) {
+                total += counts[i];
+                if (total >= k) {
+                    bound = i;
+                    break;
+                }
+            }
+        }
+    }
+    found.erase(std::remove_if(found.begin(), found.end(), [bound](const suggestion& s) { return s.distance > bound; }),
+                found.end());
+    std::sort(found.begin(), found.end(), [](const suggestion& a, const suggestion& b) {
+        return a.distance != b.distance ? a.distance < b.distance : a.index < b.index;
+    });
+    if (found.size() > k) {
+        found.resize(k);
+    }
+    return found;
+}
+} // namespace suggest_detail
+
+using suggestion = suggest_detail::suggestion;
+
+// Runtime index, built at startup (large keyword sets)
+class keyword_suggester
+{
+public:
+    // Build the index of a keyword list
+    explicit keyword_suggester(const std::vector<std::string>& words)
+      : _words(words)
+    {
+        for (std::size_t i = 0; i < _words.size(); i++) {
+            suggest_detail::for_each_variant(_words[i],
+                                             [&](uint32_t fp) { _entries.push_back(entry{ fp, uint32_t(i) }); });
+        }
+        std::sort(_entries.begin(), _entries.end(), [](const entry& a, const entry& b) {
+            return a.fingerprint != b.fingerprint ? a.fingerprint < b.fingerprint : a.index < b.index;
+        });
+        _entries.erase(std::unique(_entries.begin(),
+                                   _entries.end(),
+                                   [](const entry& a, const entry& b) {
+                                       return a.fingerprint == b.fingerprint && a.index == b.index;
+                                   }),
+                       _entries.end());
+
+        // Directory on the high fingerprint bits, about one entry per slot
+        while ((std::size_t(1) << _bits) < _entries.size() && _bits < 24) {
+            _bits++;
+        }
+        _directory.assign((std::size_t(1) << _bits) + 1, 0);
+        for (std::size_t d = 0, i = 0; d < _directory.size(); d++) {
+            while (i < _entries.size() && (_entries[i].fingerprint >> (32 - _bits)) < d) {
+                i++;
+            }
+            _directory[d] = uint32_t(i);
+        }
+    }
+
+    /**
+     * Suggest the keywords closest to a query
+     * @param query The (unknown) query
+     * @param max The maximum edit distance (at most 2)
+     * @param k The maximum number of suggestions
+     * @return The suggestions, by increasing distance
+     */
+    std::vector<suggestion> suggest(std::string_view query, std::size_t max = 2, std::size_t k = 1) const
+    {
+        return suggest_detail::lookup(
+          query,
+          max,
+          k,
+          [this](const std::vector<uint32_t>& fps, auto&& found) {
+              // Independent random accesses: prefetch them all, directory first
+              for (const uint32_t fp : fps) {
+                  __builtin_prefetch(&_directory[fp >> (32 - _bits)]);
+              }
+              for (const uint32_t fp : fps) {
+                  __builtin_prefetch(&_entries[_directory[fp >> (32 - _bits)]]);
+              }
+              for (const uint32_t fp : fps) {
+                  const std::size_t d = fp >> (32 - _bits);
+                  for (std::size_t i = _directory[d]; i < _directory[d + 1]; i++) {
+                      if (_entries[i].fingerprint == fp) {
+                          found(_entries[i].index);
+                      }
+                  }
+              }
+          },
+          [this](std::size_t index) { return std::string_view(_words[index]); });
+    }
+
+    // Keyword, by index
+    const std::string& word(std::size_t index) const { return _words[index]; }
+
+    // Index memory footprint, in bytes (keywords excluded)
+    std::size_t memory() const
+    {
+        return _entries.size() * sizeof(entry) + _directory.size() * sizeof(uint32_t);
+    }
+
+private:
+    struct entry
+    {
+        uint32_t fingerprint;
+        uint32_t index; // Keyword index
+    };
+
+    std::vector<std::string> _words;
+    std::vector<entry> _entries;         // Sorted by fingerprint
+    std::vector<uint32_t> _directory;    // First entry for each value of the '_bits' high fingerprint bits
+    unsigned _bits = 1;
+};
+
+// Compile-time index (small keyword sets), see make_suggest_index
+template<std::size_t Words, std::size_t Entries>
+struct static_suggest_index
+{
+    std::array<std::string_view, Words> words;
+    std::array<uint32_t, Entries> fingerprints; // Sorted
+    std::array<uint32_t, Entries> indexes;      // Keyword index, for each fingerprint
+
+    std::vector<suggestion> suggest(std::string_view query, std::size_t max = 2, std::size_t k = 1) const
+    {
+        return suggest_detail::lookup(
+          query,
+          max,
+          k,
+          [this](const std::vector<uint32_t>& fps, auto&& found) {
+              for (const uint32_t fp : fps) {
+                  auto it = std::lower_bound(fingerprints.begin(), fingerprints.end(), fp);
+                  for (; it != fingerprints.end() && *it == fp; ++it) {
+                      found(indexes[it - fingerprints.begin()]);
+                  }
+              }
+          },
+          [this](std::size_t index) { return words[index]; });
+    }
+};
+
+// Number of index entries for a keyword list, to be passed to make_suggest_index
+template<std::size_t Words>
+constexpr std::size_t suggest_index_size(const std::array<std::string_view, Words>& words)
+{
+    std::size_t size = 0;
+    for (const auto& word : words) {
+        size += suggest_detail::variants(word.size());
+    }
+    return size;
+}
+
+/**
+ * Build a suggestion index at compile time
+ * @comment constexpr auto index = make_suggest_index<suggest_index_size(words)>(words);
+ */
+template<std::size_t Entries, std::size_t Words>
+constexpr static_suggest_index<Words, Entries> make_suggest_index(const std::array<std::string_view, Words>& words)
+{
+    static_suggest_index<Words, Entries> index = {};
+    index.words = words;
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < Words; i++) {
+        suggest_detail::for_each_variant(words[i], [&](uint32_t fp) {
+            // Insertion sort: small sets only
+            std::size_t j = count++;
+            for (; j != 0 && index.fingerprints[j - 1] > fp; j--) {
+                index.fingerprints[j] = index.fingerprints[j - 1];
+                index.indexes[j] = index.indexes[j - 1];
+            }
+            index.fingerprints[j] = fp;
+            index.indexes[j] = uint32_t(i);
+        });
+    }
+    return index;
+}
@@ -0,0 +1,307 @@
+/**
+ * Symbol encoding of strings for IPC and logs: known strings are sent as their fnv1a64 ID, others inline.
+ * @comment A value is either a symbol, a 0x01 byte followed by the 8-byte little-endian fnv1a64 hash of a known string,
+ * or an inline string, a LEB128 varint of twice its length followed by its bytes. The IDs do not depend on the order
+ * or version of the known string lists: a sender can use compile-time IDs ("field"_fnv1a64), and the receiver
+ * decodes them through its symbol_table, a hash table of the known strings by ID. Strings of up to 8 bytes are sent
+ * inline, which is never longer than a symbol.
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fnv1a_index.h"
+#include "switch_fnv1a.h"
+
+// Known strings, by fnv1a64 ID
+class symbol_table
+{
+public:
+    /**
+     * Build the table
+     * @comment A string whose ID collides with a previous one is not a symbol: it is always sent inline
+     * @param names The known strings (any container of std::string_view-convertible values)
+     */
+    template<typename Container>
+    explicit symbol_table(const Container& names)
+    {
+        std::size_t count = 0;
+        for (const auto& name : names) {
+            (void) name;
+            count++;
+        }
+        std::size_t bits = 4;
+        while ((std::size_t(1) << bits) < count * 2) {
+            bits++;
+        }
+        _slots.assign(std::size_t(1) << bits, 0);
+        _mask = _slots.size() - 1;
+        _bits = bits;
+
+        for (const auto& value : names) {
+            const std::string_view name(value);
+            const uint64_t id = fnv1a64::hash(name);
+            std::size_t s = index(id);
+            while (_slots[s] != 0 && _ids[_slots[s] - 1] != id) {
+                s = (s + 1) & _mask;
+            }
+            if (_slots[s] == 0) {
+                _ids.push_back(id);
+                _blob.append(name);
+                _offsets.push_back(uint32_t(_blob.size()));
+                _slots[s] = uint32_t(_ids.size());
+            }
+        }
+    }
+
+    /**
+     * Name of an ID
+     * @param id The ID
+     * @param name The name, if known
+     * @return true if the ID is known
+     */
+    bool name(uint64_t id, std::string_view& name) const
+    {
+        const uint32_t entry = find(id);
+        if (entry == 0) {
+            return false;
+        }
+        name = std::string_view(_blob.data() + _offsets[entry - 1], _offsets[entry] - _offsets[entry - 1]);
+        return true;
+    }
+
+    /**
+     * Whether a string is known
+     * @param value The string
+     * @param id Its fnv1a64 hash
+     */
+    bool contains(std::string_view value, uint64_t id) const
+    {
+        const uint32_t entry = find(id);
+        return entry != 0 && _offsets[entry] - _offsets[entry - 1] == value.size()
+               && std::memcmp(_blob.data() + _offsets[entry - 1], value.data(), value.size()) == 0;
+    }
+
+    // Prefetch the slot of an ID
+    void prefetch(uint64_t id) const { __builtin_prefetch(&_slots[index(id)]); }
+
+    // Number of known strings
+    std::size_t size() const { return _ids.size(); }
+
+    // Memory footprint, in bytes
+    std::size_t memory() const
+    {
+        return _slots.size() * sizeof(uint32_t) + _ids.size() * sizeof(uint64_t) + _offsets.size() * sizeof(uint32_t)
+               + _blob.size();
+    }
+
+private:
+    std::size_t index(uint64_t id) const { return fnv1a_index::fibonacci(id, _bits); }
+
+    // 1-based entry of an ID, 0 if unknown
+    uint32_t find(uint64_t id) const
+    {
+        for (std::size_t s = index(id);; s = (s + 1) & _mask) {
+            const uint32_t entry = _slots[s];
+            if (entry == 0 || _ids[entry - 1] == id) {
+                return entry;
+            }
+        }
+    }
+
+    std::vector<uint32_t> _slots; // 1-based entries, 0 if empty
+    std::vector<uint64_t> _ids;
+    std::vector<uint32_t> _offsets = { 0 }; // Name offsets in _blob, plus the final size
+    std::string _blob;
+    std::size_t _mask = 0;
+    unsigned _bits = 0;
+};
+
+class symbol_encoder
+{
+public:
+    // Values hashed and prefetched at once by batch encoding
+    static constexpr std::size_t batch = 64;
+
+    // Symbol marker
+    static constexpr uint8_t symbol_tag = 0x01;
+
+    // The table must outlive the encoder
+    explicit symbol_encoder(const symbol_table& table)
+      : _table(table)
+    {}
+
+    // Append a string, as a symbol if known
+    void put(std::string_view value) { put(value, fnv1a64::hash(value)); }
+
+    /**
+     * Append a string, as a symbol if known
+     * @param value The string
+     * @param id Its fnv1a64 hash
+     */
+    void put(std::string_view value, uint64_t id)
+    {
+        if (value.size() > sizeof(uint64_t) && _table.contains(value, id)) {
+            put_id(id);
+        } else {
+            put_inline(value);
+        }
+    }
+
+    /**
+     * Append a known string by ID, such as a compile-time "name"_fnv1a64 value, without hashing nor checking it
+     * @param id The ID, which the decoder's symbol_table must know
+     */
+    void put_id(uint64_t id)
+    {
+        char bytes[1 + sizeof(uint64_t)];
+        bytes[0] = char(symbol_tag);
+        for (std::size_t i = 0; i < sizeof(uint64_t); i++) {
+            bytes[1 + i] = char(id >> (8 * i));
+        }
+        _data.append(bytes, sizeof(bytes));
+    }
+
+    // Append a string inline
+    void put_inline(std::string_view value)
+    {
+        char bytes[10];
+        std::size_t size = 0;
+        for (uint64_t v = uint64_t(value.size()) * 2;; v >>= 7) {
+            if (v < 0x80) {
+                bytes[size++] = char(v);
+                break;
+            }
+            bytes[size++] = char(0x80 | (v & 0x7f));
+        }
+        _data.append(bytes, size);
+        _data.append(value);
+    }
+
+    /**
+     * Append a batch of strings: all of them are hashed and their table slots prefetched first
+     * @param values The strings
+     * @param count The number of strings
+     */
+    void put(const std::string_view* values, std::size_t count)
+    {
+        uint64_t ids[batch];
+        _data.reserve(_data.size() + count * (1 + sizeof(uint64_t)));
+        for (std::size_t first = 0; first < count; first += batch) {
+            const std::size_t size = std::min(batch, count - first);
+            for (std::size_t i = 0; i < size; i++) {
+                ids[i] = fnv1a64::hash(values[first + i]);
+                _table.prefetch(ids[i]);
+            }
+            for (std::size_t i = 0; i < size; i++) {
+                put(values[first + i], ids[i]);
+            }
+        }
+    }
+
+    // The encoded values
+    const std::string& data() const { return _data; }
+
+    void clear() { _data.clear(); }
+
+private:
+    const symbol_table& _table;
+    std::string _data;
+};
+
+class symbol_decoder
+{
+public:
+    /**
+     * Create a decoder
+     * @comment Decoded strings point into the table (symbols) or into the data (inline strings)
+     * @param table The table, which must know every symbol of the data
+     * @param data The encoded values
+     */
+    symbol_decoder(const symbol_table& table, std::string_view data)
+      : _table(table)
+      , _data(data)
+    {}
+
+    /**
+     * Decode the next value
+     * @param value The value
+     * @return false at the end of the data, or on an error (see failed())
+     */
+    bool next(std::string_view& value)
+    {
+        if (_data.empty() || _failed) {
+            return false;
+        }
+        const uint8_t* const p = reinterpret_cast<const uint8_t*>(_data.data());
+        if (p[0] == symbol_encoder::symbol_tag) {
+            if (_data.size() < 1 + sizeof(uint64_t)) {
+                return fail();
+            }
+            uint64_t id = 0;
+            for (std::size_t i = 0; i < sizeof(uint64_t); i++) {
+                id |= uint64_t(p[1 + i]) << (8 * i);
+            }
+            if (!_table.name(id, value)) {
+                return fail();
+            }
+            _data.remove_prefix(1 + sizeof(uint64_t));
+            return true;
+        }
+
+        uint64_t header = 0;
+        std::size_t size = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            if (size == _data.size() || shift > 63) {
+                return fail();
+            }
+            header |= uint64_t(p[size] & 0x7f) << shift;
+            if ((p[size++] & 0x80) == 0) {
+                break;
+            }
+        }
+        const uint64_t length = header / 2;
+        if ((header & 1) != 0 || length > _data.size() - size) {
+            return fail();
+        }
+        value = _data.substr(size, length);
+        _data.remove_prefix(size + length);
+        return true;
+    }
+
+    /**
+     * Decode a batch of values
+     * @param values The values
+     * @param count The maximum number of values
+     * @return The number of values decoded
+     */
+    std::size_t next(std::string_view* values, std::size_t count)
+    {
+        std::size_t i = 0;
+        while (i < count && next(values[i])) {
+            i++;
+        }
+        return i;
+    }
+
+    // Whether the data is truncated, malformed, or holds an unknown symbol
+    bool failed() const { return _failed; }
+
+private:
+    bool fail()
+    {
+        _failed = true;
+        return false;
+    }
+
+    const symbol_table& _table;
+    std::string_view _data;
+    bool _failed = false;
+};
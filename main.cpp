@@ -4,15 +4,27 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <iostream>
 #include <random>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <stdint.h>
 #include <string.h>
 
+// Cold lookups by clflush of the program segments: x86, and dl_iterate_phdr() to find the segments
+#if (defined(__x86_64__) || defined(__i386__)) && __has_include(<link.h>)
+#include <immintrin.h>
+#include <link.h>
+#define COLD_CLFLUSH
+#endif
+
+#include "fnv1a_pool.h"
+#include "fnv1a_reverse.h"
+#include "fnv1a_suggest.h"
 #include "switch_fnv1a.h"
 
 #define L_(L) #L
@@ -21,6 +33,9 @@
 // Execute benchmarks ?
 #define ENABLE_BENCHS
 
+// Cold-cache benchmarks: "demo --cold" (clflush of the program, where available), or "demo --cold-sweep" (scratch
+// buffer sweep)
+
 // Small (100 cases) benchs ?
 // #define SMALL_BENCHS
 
@@ -44,6 +59,28 @@ const char* dispatch(const fnv1a128::Type match)
     }
 }
 
+// Known animals, for "did you mean" suggestions (index built at compile time)
+constexpr std::array<std::string_view, 4> animals = { "poney", "elephant", "dog", "kitten" };
+constexpr auto animals_index = make_suggest_index<suggest_index_size(animals)>(animals);
+
+// Names of the 1000 words, from their hash (reverse table built at compile time)
+constexpr std::size_t words_count = [] {
+    std::size_t n = 0;
+#define WORD(W) n++
+#include "include/words-extract.h"
+#undef WORD
+    return n;
+}();
+constexpr auto words = [] {
+    std::array<std::string_view, words_count> names{};
+    std::size_t n = 0;
+#define WORD(W) names[n++] = W
+#include "include/words-extract.h"
+#undef WORD
+    return names;
+}();
+constexpr auto words_names = make_reverse_table<reverse_table_size(words)>(words);
+
 // Long switch of 1000 'case
 constexpr const char* dispatch_1000(const fnv1a128::Type match)
 {
@@ -63,6 +100,64 @@ constexpr const char* dispatch_1000(const fnv1a128::Type match)
     }
 }
 
+// Relocation-free version of dispatch_1000: index of the result in dispatch_1000_results (0 if unknown)
+constexpr uint32_t dispatch_1000_base = __COUNTER__;
+constexpr uint32_t dispatch_1000_index(const fnv1a128::Type match)
+{
+    switch (match) {
+#define WORD(W)        \
+    case W##_fnv1a128: \
+        return __COUNTER__ - dispatch_1000_base
+#ifndef SMALL_BENCHS
+#include "include/words-extract.h"
+#else
+#include "include/words-extract-small.h"
+#endif
+#undef WORD
+
+    default:
+        return 0;
+    }
+}
+
+// Results of dispatch_1000_index, as one string blob with 32-bit offsets
+constexpr auto dispatch_1000_strings = [] {
+    constexpr std::size_t count = [] {
+        std::size_t n = 1;
+#define WORD(W) n++
+#ifndef SMALL_BENCHS
+#include "include/words-extract.h"
+#else
+#include "include/words-extract-small.h"
+#endif
+#undef WORD
+        return n;
+    }();
+    std::array<std::string_view, count> results{};
+    std::size_t n = 0;
+    results[n++] = "unknown!";
+#define WORD(W) results[n++] = L(__LINE__)
+#ifndef SMALL_BENCHS
+#include "include/words-extract.h"
+#else
+#include "include/words-extract-small.h"
+#endif
+#undef WORD
+    return results;
+}();
+constexpr auto dispatch_1000_results = make_string_pool<string_pool_size(dispatch_1000_strings)>(dispatch_1000_strings);
+
+// Both dispatchers agree
+static_assert([] {
+    for (const auto& word : words) {
+        const auto hash = fnv1a128::hash(word.data(), word.size());
+        if (dispatch_1000_results[dispatch_1000_index(hash)] != dispatch_1000(hash)) {
+            return false;
+        }
+    }
+    return dispatch_1000_results[dispatch_1000_index("not-a-word"_fnv1a128)] == dispatch_1000("not-a-word"_fnv1a128);
+}());
+
 // Hash-switch version
 auto compute_hash(const char *str, size_t size)
 {
@@ -153,12 +248,117 @@ static void bench(void)
     }
 }
 
+#if defined(COLD_CLFLUSH)
+// Mapped segments (code, tables, data) of the executable, for cache eviction
+static std::vector<std::pair<const char*, size_t>> program_segments()
+{
+    std::vector<std::pair<const char*, size_t>> segments;
+    dl_iterate_phdr(
+      [](struct dl_phdr_info* info, size_t, void* data) {
+          auto& segments = *static_cast<std::vector<std::pair<const char*, size_t>>*>(data);
+          for (int i = 0; i < info->dlpi_phnum; i++) {
+              if (info->dlpi_phdr[i].p_type == PT_LOAD) {
+                  segments.emplace_back(reinterpret_cast<const char*>(info->dlpi_addr + info->dlpi_phdr[i].p_vaddr),
+                                        info->dlpi_phdr[i].p_memsz);
+              }
+          }
+          return 1; // The executable comes first
+      },
+      &segments);
+    return segments;
+}
+#endif
+
+/**
+ * Latency of single cold (or warm) lookups
+ * @comment Before each cold lookup, the program code and tables are flushed from all cache levels (clflush), or the
+ * caches are filled with a scratch buffer sweep (the only method without clflush or dl_iterate_phdr). Branch
+ * predictors and TLBs are not reset.
+ * @param sweep Use a scratch buffer sweep instead of clflush
+ */
+static void cold_bench(bool sweep)
+{
+    constexpr size_t samples = 1000;
+#if !defined(COLD_CLFLUSH)
+    sweep = true;
+#endif
+    std::vector<std::string> strings;
+#define WORD(W) strings.push_back(W)
+#include "include/words-extract-match.h"
+#undef WORD
+    std::shuffle(strings.begin(), strings.end(), std::default_random_engine(42));
+
+#if defined(COLD_CLFLUSH)
+    const auto segments = program_segments();
+    size_t program = 0;
+    for (const auto& segment : segments) {
+        program += segment.second;
+    }
+#else
+    const size_t program = 0;
+#endif
+    std::vector<char> scratch(sweep ? size_t(64) << 20 : 0);
+    const auto evict = [&] {
+        if (sweep) {
+            for (size_t i = 0; i < scratch.size(); i += 64) {
+                scratch[i]++;
+            }
+            return;
+        }
+#if defined(COLD_CLFLUSH)
+        for (const auto& segment : segments) {
+            for (size_t offset = 0; offset < segment.second; offset += 64) {
+                _mm_clflush(segment.first + offset);
+            }
+        }
+        _mm_mfence();
+#endif
+    };
+    std::cerr << "Cold lookups: " << samples << " per strategy, "
+              << (sweep ? "64MB scratch sweep" : std::to_string(program >> 10) + "KB of program flushed")
+              << " before each one (ns, timer overhead included)\n";
+
+    volatile char sink = 0;
+    const auto measure = [&](const char* name, auto&& lookup) {
+        std::vector<uint64_t> latencies[2];
+        for (const bool cold : { false, true }) {
+            for (size_t i = 0; i < samples; i++) {
+                const std::string& string = strings[i % strings.size()];
+                if (cold) {
+                    evict();
+                } else {
+                    sink = sink + lookup(string)[0];
+                }
+                const auto start = std::chrono::steady_clock::now();
+                const char* const match = lookup(string);
+                const auto end = std::chrono::steady_clock::now();
+                sink = sink + match[0];
+                latencies[cold].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            }
+            std::sort(latencies[cold].begin(), latencies[cold].end());
+        }
+        const auto& c = latencies[1];
+        std::cerr << name << ": warm p50 " << latencies[0][samples / 2] << ", cold p50 " << c[samples / 2] << " p90 "
+                  << c[samples * 9 / 10] << " p99 " << c[samples * 99 / 100] << " max " << c.back() << "\n";
+    };
+    measure("Timer only", [](const std::string&) { return ""; });
+    measure("Naive if", [](const std::string& s) { return match_if(s); });
+    measure("Hashed switch", [](const std::string& s) { return match_case(s); });
+    measure("Hashed switch, offsets", [](const std::string& s) {
+        return dispatch_1000_results[dispatch_1000_index(compute_hash(s.c_str(), s.size()))].data();
+    });
+}
+
 int main(int argc, char** argv)
 {
     // Execute benchmarks ?
 #ifdef ENABLE_BENCHS
     if (argc == 1)
         bench();
+    if (argc == 2 && (strcmp(argv[1], "--cold") == 0 || strcmp(argv[1], "--cold-sweep") == 0)) {
+        cold_bench(strcmp(argv[1], "--cold-sweep") == 0);
+        return 0;
+    }
 #endif
 
     // Demo
@@ -166,7 +366,15 @@ int main(int argc, char** argv)
         const auto hash = fnv1a128::hash(argv[i]);
 
         std::cout << dispatch(hash) << "\n";
-        std::cout << "Hash value:" << std::hex << ((uint64_t)(hash >> 64)) << ((uint64_t)(hash)) << "\n";
+        const auto suggestions = animals_index.suggest(argv[i]);
+        if (!suggestions.empty() && suggestions[0].distance != 0) {
+            std::cout << "Did you mean " << animals[suggestions[0].index] << "?\n";
+        }
+        std::cout << "Hash value:" << std::hex << ((uint64_t)(hash >> 64)) << ((uint64_t)(hash)) << std::dec << "\n";
+        const std::string_view name = words_names.name_of(hash);
+        if (!name.empty()) {
+            std::cout << "Known word: " << name << "\n";
+        }
     }
 
     return 0;
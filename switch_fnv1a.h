@@ -12,6 +12,10 @@
 #include <string>
 #include <type_traits>
 
+#if defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
 // Traits for FNV1a
 template<size_t Bits>
 struct fnv1a_traits
@@ -57,6 +61,114 @@ struct fnv1a_traits<128>
     static constexpr Type Offset = Pack128(0x6c62272e07bb0142, 0x62b821756295c58d);
 };
 
+// Compile-time set of stop characters, for fnv1a::hash_until
+template<uint8_t... Chars>
+struct stop_set
+{
+    static_assert(sizeof...(Chars) != 0);
+
+    static constexpr bool contains(uint8_t c) { return ((c == Chars) || ...); }
+
+    // Nibble tables for the pshufb classifier: c is in the set iff (lo[c & 15] & hi[c >> 4]) != 0
+    // Each distinct high nibble gets its own bit, so the classification is exact with up to 8 of them
+    struct nibbles
+    {
+        uint8_t lo[16];
+        uint8_t hi[16];
+        bool exact;
+    };
+
+    static constexpr nibbles build()
+    {
+        nibbles n = {};
+        n.exact = true;
+        const uint8_t chars[] = { Chars... };
+        std::size_t bits = 0;
+        for (const uint8_t c : chars) {
+            const uint8_t h = c >> 4;
+            if (n.hi[h] == 0) {
+                if (bits == 8) {
+                    n.exact = false;
+                    break;
+                }
+                n.hi[h] = uint8_t(1) << bits++;
+            }
+            n.lo[c & 15] |= n.hi[h];
+        }
+        return n;
+    }
+
+    static constexpr nibbles tables = build();
+};
+
+// Usual token delimiters
+using stop_space = stop_set<' ', '\t', '\r', '\n'>;
+using stop_token = stop_set<' ', '\t', '\r', '\n', '=', ':', ';', ','>;
+
+namespace fnv1a_simd {
+#if defined(__AVX2__)
+static constexpr std::size_t width = 32;
+#elif defined(__SSSE3__)
+static constexpr std::size_t width = 16;
+#endif
+
+// Bytes scanned one at a time before switching to blocks: short tokens do not pay for a block classification
+static constexpr std::size_t scalar_prefix = 8;
+
+#if defined(__SSSE3__)
+/**
+ * Classify 'width' bytes against a stop set
+ * @param s The bytes (no alignment requirement)
+ * @return A bitmask of the positions holding a stop character
+ */
+template<typename Stop>
+static inline uint32_t classify(const void* s)
+{
+    static_assert(Stop::tables.exact);
+#if defined(__AVX2__)
+    const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Stop::tables.lo)));
+    const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Stop::tables.hi)));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    const __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(v, nibble));
+    const __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+    const __m256i none = _mm256_cmpeq_epi8(_mm256_and_si256(l, h), _mm256_setzero_si256());
+    return ~uint32_t(_mm256_movemask_epi8(none));
+#else
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Stop::tables.lo));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Stop::tables.hi));
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(v, nibble));
+    const __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+    const __m128i none = _mm_cmpeq_epi8(_mm_and_si128(l, h), _mm_setzero_si128());
+    return ~uint32_t(_mm_movemask_epi8(none)) & 0xffff;
+#endif
+}
+
+/**
+ * Lowercase (ASCII 'A'..'Z' only) 'width' bytes
+ * @param s The bytes (no alignment requirement)
+ * @param out The destination (no alignment requirement)
+ */
+static inline void lowercase(const void* s, void* out)
+{
+#if defined(__AVX2__)
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                        _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8('a' - 'A'))));
+#else
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i upper =
+      _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A'))));
+#endif
+}
+#endif
+} // namespace fnv1a_simd
+
 // Generic FNV1a implementation
 template<size_t Bits>
 struct fnv1a
@@ -96,6 +208,222 @@ struct fnv1a
         return hash;
     }
 
+    /**
+     * Compute the Fowler–Noll–Vo hash of a NUL-terminated string in a single pass
+     * @comment The terminator is searched one aligned 64-bit word at a time; an aligned load never crosses a page
+     * boundary, so reading past the terminator is harmless (the same trick is used by libc strlen)
+     * @param s The NUL-terminated string
+     * @param len If not nullptr, receives the string length
+     * @return The fnv-1a hash (identical to hash(s, strlen(s)))
+     */
+#if defined(__SANITIZE_ADDRESS__)
+    __attribute__((no_sanitize_address))
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+    __attribute__((no_sanitize_address))
+#endif
+#endif
+    static Type hash_cstr(const char* s, std::size_t* len = nullptr, Type hash = fnv1a_traits<Bits>::Offset)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        constexpr uint64_t ones = 0x0101010101010101;
+        constexpr uint64_t highs = 0x8080808080808080;
+
+        const uintptr_t addr = reinterpret_cast<uintptr_t>(s);
+        const char* p = reinterpret_cast<const char*>(addr & ~uintptr_t(7));
+        std::size_t from = addr & 7;
+
+        // Bytes located before the string start must not be seen as terminators
+        uint64_t w;
+        __builtin_memcpy(&w, __builtin_assume_aligned(p, 8), 8);
+        w |= (uint64_t(1) << (from * 8)) - 1;
+
+        // "haszero": exact for the lowest zero byte, which is the only one we care about
+        uint64_t zero = (w - ones) & ~w & highs;
+        if (zero == 0) {
+            for (std::size_t j = from; j < 8; j++) {
+                hash ^= uint8_t(p[j]);
+                hash *= fnv1a_traits<Bits>::Prime;
+            }
+            for (;;) {
+                p += 8;
+                __builtin_memcpy(&w, __builtin_assume_aligned(p, 8), 8);
+                zero = (w - ones) & ~w & highs;
+                if (zero != 0) {
+                    break;
+                }
+                for (std::size_t j = 0; j < 8; j++) {
+                    hash ^= uint8_t(p[j]);
+                    hash *= fnv1a_traits<Bits>::Prime;
+                }
+            }
+            from = 0;
+        }
+
+        // Last word, holding the terminator
+        const std::size_t to = __builtin_ctzll(zero) / 8;
+        for (std::size_t j = from; j < to; j++) {
+            hash ^= uint8_t(p[j]);
+            hash *= fnv1a_traits<Bits>::Prime;
+        }
+        if (len != nullptr) {
+            *len = p + to - s;
+        }
+        return hash;
+#else
+        const std::size_t l = __builtin_strlen(s);
+        if (len != nullptr) {
+            *len = l;
+        }
+        return hash_container(s, l, nullptr, hash);
+#endif
+    }
+
+    /**
+     * Compute the Fowler–Noll–Vo hash, stopping at the first character of a stop set
+     * @comment Stop The stop set (see stop_set<>); at runtime, in SSSE3/AVX2 builds, the set is matched 16 or 32 bytes
+     * at a time, after a scalar scan of the first fnv1a_simd::scalar_prefix bytes (other builds scan byte by byte)
+     * @param s The string
+     * @param l The string size
+     * @param stopLen If not nullptr, receives the position following the stop character (if one was found)
+     * @return The fnv-1a hash
+     */
+    template<typename Stop, typename C, typename L = decltype(nullptr)>
+    static constexpr Type hash_until(const C* s,
+                                     const std::size_t l,
+                                     L stopLen = nullptr,
+                                     Type hash = fnv1a_traits<Bits>::Offset)
+    {
+        // Accept [ unsigned | signed ] char
+        static_assert(std::is_integral<C>::value);
+        static_assert(sizeof(C) == 1);
+
+        std::size_t j = 0;
+#if defined(__SSSE3__)
+        if constexpr (Stop::tables.exact) {
+            if (!__builtin_is_constant_evaluated()) {
+                for (; j < l && j < fnv1a_simd::scalar_prefix; j++) {
+                    const uint8_t byte = s[j];
+                    if (Stop::contains(byte)) {
+                        if constexpr (!std::is_same<L, decltype(nullptr)>::value) {
+                            *stopLen = j + 1;
+                        }
+                        return hash;
+                    }
+                    hash ^= byte;
+                    hash *= fnv1a_traits<Bits>::Prime;
+                }
+                for (; j + fnv1a_simd::width <= l; j += fnv1a_simd::width) {
+                    const uint32_t mask = fnv1a_simd::classify<Stop>(s + j);
+                    if (mask == 0) {
+                        for (std::size_t k = 0; k < fnv1a_simd::width; k++) {
+                            hash ^= uint8_t(s[j + k]);
+                            hash *= fnv1a_traits<Bits>::Prime;
+                        }
+                        continue;
+                    }
+                    const std::size_t to = __builtin_ctz(mask);
+                    for (std::size_t k = 0; k < to; k++) {
+                        hash ^= uint8_t(s[j + k]);
+                        hash *= fnv1a_traits<Bits>::Prime;
+                    }
+                    if constexpr (!std::is_same<L, decltype(nullptr)>::value) {
+                        *stopLen = j + to + 1;
+                    }
+                    return hash;
+                }
+            }
+        }
+#endif
+        for (; j < l; j++) {
+            const uint8_t byte = s[j];
+            if (Stop::contains(byte)) {
+                if constexpr (!std::is_same<L, decltype(nullptr)>::value) {
+                    *stopLen = j + 1;
+                }
+                break;
+            }
+            hash ^= byte;
+            hash *= fnv1a_traits<Bits>::Prime;
+        }
+
+        return hash;
+    }
+
+    /**
+     * Compute the Fowler–Noll–Vo hash of a string read backward, from its end toward its start
+     * @comment stop An optional stop character; unlike hash_container(), it is hashed too, so that the hash of
+     * "photo.jpg" stopping at '.' is the hash of "gpj.", ie. ".jpg"_fnv1a128_rev
+     * @param s The string
+     * @param l The string size
+     * @param stopLen If not nullptr, receives the number of characters consumed, including the stop character (if one
+     * was found); hashing the remaining l - *stopLen characters with the returned hash as seed continues the scan
+     * @return The fnv-1a hash
+     */
+    template<uint8_t stop = 0, typename C, typename L = decltype(nullptr)>
+    static constexpr Type hash_reverse(const C* s,
+                                       const std::size_t l,
+                                       L stopLen = nullptr,
+                                       Type hash = fnv1a_traits<Bits>::Offset)
+    {
+        // Accept [ unsigned | signed ] char
+        static_assert(std::is_integral<C>::value);
+        static_assert(sizeof(C) == 1);
+
+        for (std::size_t j = l; j != 0; j--) {
+            const uint8_t byte = s[j - 1];
+            hash ^= byte;
+            hash *= fnv1a_traits<Bits>::Prime;
+            if constexpr (stop != 0) {
+                if (byte == stop) {
+                    if constexpr (!std::is_same<L, decltype(nullptr)>::value) {
+                        *stopLen = l - j + 1;
+                    }
+                    break;
+                }
+            }
+        }
+
+        return hash;
+    }
+
+    /**
+     * Compute a sampled Fowler–Noll–Vo hash, for very long keys: the first 'Prefix' and last 'Suffix' characters,
+     * every 'Stride'-th character in between (if 'Stride' is not zero), and the length
+     * @comment Two different keys may share the same samples: a match MUST be verified against the full string
+     * @param s The string
+     * @param l The string size
+     * @return The sampled fnv-1a hash
+     */
+    template<std::size_t Prefix = 32, std::size_t Suffix = 32, std::size_t Stride = 0, typename C>
+    static constexpr Type hash_sampled(const C* s, const std::size_t l, Type hash = fnv1a_traits<Bits>::Offset)
+    {
+        // Accept [ unsigned | signed ] char
+        static_assert(std::is_integral<C>::value);
+        static_assert(sizeof(C) == 1);
+
+        if (l <= Prefix + Suffix) {
+            hash = hash_container(s, l, nullptr, hash);
+        } else {
+            hash = hash_container(s, Prefix, nullptr, hash);
+            if constexpr (Stride != 0) {
+                for (std::size_t j = Prefix + Stride - 1; j < l - Suffix; j += Stride) {
+                    hash ^= uint8_t(s[j]);
+                    hash *= fnv1a_traits<Bits>::Prime;
+                }
+            }
+            hash = hash_container(s + l - Suffix, Suffix, nullptr, hash);
+        }
+
+        // Length, so that keys sharing their samples differ
+        for (std::size_t i = 0; i < sizeof(uint64_t); i++) {
+            hash ^= uint8_t(uint64_t(l) >> (i * 8));
+            hash *= fnv1a_traits<Bits>::Prime;
+        }
+
+        return hash;
+    }
+
     /**
      * Compute the Fowler–Noll–Vo hash
      * @comment stop An optional stop character
@@ -138,7 +466,14 @@ struct fnv1a
      * @param s The string
      * @return The fnv-1a hash
      */
-    static constexpr Type hash(const char* s) { return hash(s, __builtin_strlen(s)); }
+    static constexpr Type hash(const char* s)
+    {
+        // Single pass at runtime, strlen-then-hash when evaluated at build-time
+        if (__builtin_is_constant_evaluated()) {
+            return hash(s, __builtin_strlen(s));
+        }
+        return hash_cstr(s);
+    }
 
     /**
      * Compute the Fowler–Noll–Vo hash
@@ -179,10 +514,45 @@ constexpr fnv1a128::Type operator"" _fnv1a128(const char* s, const std::size_t l
     return fnv1a128::hash(s, l);
 }
 
+// Reversed literals, for suffix dispatch with fnv1a::hash_reverse
+constexpr fnv1a32::Type operator"" _fnv1a32_rev(const char* s, const std::size_t l)
+{
+    return fnv1a32::hash_reverse(s, l);
+}
+constexpr fnv1a64::Type operator"" _fnv1a64_rev(const char* s, const std::size_t l)
+{
+    return fnv1a64::hash_reverse(s, l);
+}
+constexpr fnv1a128::Type operator"" _fnv1a128_rev(const char* s, const std::size_t l)
+{
+    return fnv1a128::hash_reverse(s, l);
+}
+
+// Sampled versions (see fnv1a::hash_sampled), for very long keys: matches MUST be verified against the full string
+constexpr fnv1a32::Type operator"" _fnv1a32_sampled(const char* s, const std::size_t l)
+{
+    return fnv1a32::hash_sampled(s, l);
+}
+constexpr fnv1a64::Type operator"" _fnv1a64_sampled(const char* s, const std::size_t l)
+{
+    return fnv1a64::hash_sampled(s, l);
+}
+constexpr fnv1a128::Type operator"" _fnv1a128_sampled(const char* s, const std::size_t l)
+{
+    return fnv1a128::hash_sampled(s, l);
+}
+
 // Static unit tests: <https://fnvhash.github.io/fnv-calculator-online/>
 static_assert("hello"_fnv1a32 == 0x4f9f2cab);
 static_assert("hello"_fnv1a64 == 0xa430d84680aabd0b);
 static_assert("hello"_fnv1a128 == Pack128(0xe3e1efd54283d94f, 0x7081314b599d31b3));
+static_assert(fnv1a64::hash(static_cast<const char*>("hello")) == "hello"_fnv1a64);
+static_assert(fnv1a64::hash_until<stop_token>("hello=world", 11) == "hello"_fnv1a64);
+static_assert(fnv1a64::hash_until<stop_token>("hello", 5) == "hello"_fnv1a64);
+static_assert("olleh"_fnv1a64_rev == "hello"_fnv1a64);
+static_assert(fnv1a64::hash_reverse<'.'>("photo.jpg", 9) == ".jpg"_fnv1a64_rev);
+static_assert(fnv1a64::hash_reverse<'.'>("www.bbc.co.uk", 10, nullptr, ".uk"_fnv1a64_rev) == ".co.uk"_fnv1a64_rev);
+static_assert("hello"_fnv1a64_sampled == fnv1a64::hash("hello\x05\0\0\0\0\0\0\0", 13));
 
 using strhash = fnv1a128;
 constexpr strhash::Type operator"" _strhash(const char* s, const std::size_t l)
@@ -190,6 +560,20 @@ constexpr strhash::Type operator"" _strhash(const char* s, const std::size_t l)
     return strhash::hash(s, l);
 }
 
+// Reversed version (see fnv1a::hash_reverse)
+constexpr strhash::Type operator"" _strhash_rev(const char* s, const std::size_t l)
+{
+    return strhash::hash_reverse(s, l);
+}
+
+// Sampled version (see fnv1a::hash_sampled), for very long keys: matches MUST be verified against the full string
+constexpr strhash::Type operator"" _strhash_sampled(const char* s, const std::size_t l)
+{
+    return strhash::hash_sampled(s, l);
+}
+
+static_assert("hello"_strhash_sampled == strhash::hash("hello\x05\0\0\0\0\0\0\0", 13));
+
 // Lowercase operator[] wrapper for any operator[]-aware types
 namespace strhash_lower {
 template<typename T>
@@ -224,7 +608,7 @@ constexpr strhash::Type hash(const T& container, std::size_t size)
 /**
  * Hash a std::string, using a lowercase modifier
  */
-static constexpr strhash::Type hash(const std::string& str)
+static inline strhash::Type hash(const std::string& str)
 {
     return hash(str.c_str(), str.size());
 }
@@ -247,3 +631,334 @@ constexpr strhash::Type operator"" _strhash_lower(const char* s, const std::size
 {
     return strhash_lower::hash(s, l);
 }
+
+// Helpers for the decoding adapters below
+namespace strhash_detail {
+// Hash one more byte
+static constexpr strhash::Type step(strhash::Type hash, uint8_t byte)
+{
+    hash ^= byte;
+    hash *= fnv1a_traits<128>::Prime;
+    return hash;
+}
+
+// Hexadecimal digit value, or -1
+static constexpr int hex(uint8_t c)
+{
+    return c >= '0' && c <= '9'   ? c - '0'
+           : c >= 'a' && c <= 'f' ? c - 'a' + 10
+           : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                  : -1;
+}
+
+// Four hexadecimal digits value, or -1
+template<typename C>
+static constexpr long hex4(const C* s)
+{
+    long value = 0;
+    for (std::size_t i = 0; i < 4; i++) {
+        const int digit = hex(s[i]);
+        if (digit < 0) {
+            return -1;
+        }
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+// Hash the UTF-8 encoding of a code point
+static constexpr strhash::Type step_utf8(strhash::Type hash, long cp)
+{
+    if (cp < 0x80) {
+        return step(hash, cp);
+    } else if (cp < 0x800) {
+        return step(step(hash, 0xc0 | (cp >> 6)), 0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        return step(step(step(hash, 0xe0 | (cp >> 12)), 0x80 | ((cp >> 6) & 0x3f)), 0x80 | (cp & 0x3f));
+    }
+    return step(step(step(step(hash, 0xf0 | (cp >> 18)), 0x80 | ((cp >> 12) & 0x3f)), 0x80 | ((cp >> 6) & 0x3f)),
+                0x80 | (cp & 0x3f));
+}
+} // namespace strhash_detail
+
+// Percent-decoding ("%2F" -> '/') adapter: hash of the decoded string, invalid escapes being kept verbatim
+namespace strhash_percent {
+/**
+ * Hash 'size' characters, percent-decoded
+ * @comment Runs without escapes are scanned 16/32 bytes at a time (see fnv1a::hash_until)
+ */
+template<typename C>
+constexpr strhash::Type hash(const C* s, std::size_t size)
+{
+    strhash::Type hash = fnv1a_traits<128>::Offset;
+    for (std::size_t j = 0; j < size;) {
+        std::size_t stop = 0;
+        hash = strhash::hash_until<stop_set<'%'>>(s + j, size - j, &stop, hash);
+        if (stop == 0) {
+            break;
+        }
+        j += stop;
+
+        const int high = j + 2 <= size ? strhash_detail::hex(s[j]) : -1;
+        const int low = high >= 0 ? strhash_detail::hex(s[j + 1]) : -1;
+        if (low >= 0) {
+            hash = strhash_detail::step(hash, high * 16 + low);
+            j += 2;
+        } else {
+            hash = strhash_detail::step(hash, '%');
+        }
+    }
+    return hash;
+}
+
+/**
+ * Hash a std::string, percent-decoded
+ */
+static inline strhash::Type hash(const std::string& str)
+{
+    return hash(str.c_str(), str.size());
+}
+
+/**
+ * Hash a std::string_view, percent-decoded
+ */
+template<typename C>
+static constexpr strhash::Type hash(const std::basic_string_view<C>& str)
+{
+    // Accept [ unsigned | signed ] char
+    static_assert(std::is_integral<C>::value);
+    static_assert(sizeof(C) == 1);
+    return hash(str.data(), str.size());
+}
+} // namespace strhash_percent
+
+// JSON string unescaping ("\n", "\u00e9" -> UTF-8) adapter: hash of the unescaped string, invalid escapes being kept
+// verbatim
+namespace strhash_json {
+/**
+ * Hash 'size' characters of a JSON string body (without the enclosing quotes), unescaped
+ * @comment Runs without escapes are scanned 16/32 bytes at a time (see fnv1a::hash_until)
+ */
+template<typename C>
+constexpr strhash::Type hash(const C* s, std::size_t size)
+{
+    strhash::Type hash = fnv1a_traits<128>::Offset;
+    for (std::size_t j = 0; j < size;) {
+        std::size_t stop = 0;
+        hash = strhash::hash_until<stop_set<'\\'>>(s + j, size - j, &stop, hash);
+        if (stop == 0) {
+            break;
+        }
+        j += stop;
+
+        const uint8_t c = j < size ? s[j] : 0;
+        switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+            hash = strhash_detail::step(hash, c);
+            j++;
+            break;
+        case 'b':
+            hash = strhash_detail::step(hash, '\b');
+            j++;
+            break;
+        case 'f':
+            hash = strhash_detail::step(hash, '\f');
+            j++;
+            break;
+        case 'n':
+            hash = strhash_detail::step(hash, '\n');
+            j++;
+            break;
+        case 'r':
+            hash = strhash_detail::step(hash, '\r');
+            j++;
+            break;
+        case 't':
+            hash = strhash_detail::step(hash, '\t');
+            j++;
+            break;
+        case 'u': {
+            long cp = j + 5 <= size ? strhash_detail::hex4(s + j + 1) : -1;
+            if (cp < 0) {
+                hash = strhash_detail::step(hash, '\\');
+                break;
+            }
+            j += 5;
+
+            // Surrogate pair
+            if (cp >= 0xd800 && cp < 0xdc00 && j + 6 <= size && s[j] == '\\' && s[j + 1] == 'u') {
+                const long low = strhash_detail::hex4(s + j + 2);
+                if (low >= 0xdc00 && low < 0xe000) {
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                    j += 6;
+                }
+            }
+            hash = strhash_detail::step_utf8(hash, cp);
+        } break;
+        default:
+            hash = strhash_detail::step(hash, '\\');
+            break;
+        }
+    }
+    return hash;
+}
+
+/**
+ * Hash a std::string, JSON-unescaped
+ */
+static inline strhash::Type hash(const std::string& str)
+{
+    return hash(str.c_str(), str.size());
+}
+
+/**
+ * Hash a std::string_view, JSON-unescaped
+ */
+template<typename C>
+static constexpr strhash::Type hash(const std::basic_string_view<C>& str)
+{
+    // Accept [ unsigned | signed ] char
+    static_assert(std::is_integral<C>::value);
+    static_assert(sizeof(C) == 1);
+    return hash(str.data(), str.size());
+}
+} // namespace strhash_json
+
+// Whitespace-trimming adapter: hash of the string without its leading and trailing spaces, tabs and newlines
+namespace strhash_trim {
+/**
+ * Hash 'size' characters, trimmed
+ */
+template<typename C>
+constexpr strhash::Type hash(const C* s, std::size_t size)
+{
+    std::size_t from = 0;
+    while (from < size && stop_space::contains(s[from])) {
+        from++;
+    }
+    while (size > from && stop_space::contains(s[size - 1])) {
+        size--;
+    }
+    return strhash::hash(s + from, size - from);
+}
+
+/**
+ * Hash a std::string, trimmed
+ */
+static inline strhash::Type hash(const std::string& str)
+{
+    return hash(str.c_str(), str.size());
+}
+
+/**
+ * Hash a std::string_view, trimmed
+ */
+template<typename C>
+static constexpr strhash::Type hash(const std::basic_string_view<C>& str)
+{
+    // Accept [ unsigned | signed ] char
+    static_assert(std::is_integral<C>::value);
+    static_assert(sizeof(C) == 1);
+    return hash(str.data(), str.size());
+}
+} // namespace strhash_trim
+
+// Exact and lowercase hashes (and optionally the lowercase string) computed in a single pass
+namespace strhash_multi {
+struct variants
+{
+    strhash::Type exact; // strhash::hash()
+    strhash::Type lower; // strhash_lower::hash()
+};
+
+/**
+ * Hash as many whole SIMD blocks as possible, returning the number of bytes processed
+ */
+template<typename C>
+static inline std::size_t _hash_blocks(const C* s, std::size_t size, char* lower, variants& hash)
+{
+    std::size_t j = 0;
+#if defined(__SSSE3__)
+    uint8_t buffer[fnv1a_simd::width];
+    for (; j + fnv1a_simd::width <= size; j += fnv1a_simd::width) {
+        uint8_t* const folded = lower != nullptr ? reinterpret_cast<uint8_t*>(lower + j) : buffer;
+        fnv1a_simd::lowercase(s + j, folded);
+
+        // Two independent multiply chains, interleaved
+        for (std::size_t k = 0; k < fnv1a_simd::width; k++) {
+            hash.exact ^= uint8_t(s[j + k]);
+            hash.exact *= fnv1a_traits<128>::Prime;
+            hash.lower ^= folded[k];
+            hash.lower *= fnv1a_traits<128>::Prime;
+        }
+    }
+#else
+    (void) s;
+    (void) size;
+    (void) lower;
+    (void) hash;
+#endif
+    return j;
+}
+
+/**
+ * Hash 'size' characters, both as-is and lowercased
+ * @param s The string
+ * @param size The string size
+ * @param lower If not nullptr, receives the 'size' lowercased characters (not NUL-terminated)
+ * @return The exact and lowercase hashes
+ */
+template<typename C>
+constexpr variants hash(const C* s, std::size_t size, char* lower = nullptr)
+{
+    // Accept [ unsigned | signed ] char
+    static_assert(std::is_integral<C>::value);
+    static_assert(sizeof(C) == 1);
+
+    variants hash = { fnv1a_traits<128>::Offset, fnv1a_traits<128>::Offset };
+    std::size_t j = 0;
+    if (!__builtin_is_constant_evaluated()) {
+        j = _hash_blocks(s, size, lower, hash);
+    }
+    for (; j < size; j++) {
+        const uint8_t c = s[j];
+        const uint8_t folded = c >= 'A' && c <= 'Z' ? (c + 'a' - 'A') : c;
+        if (lower != nullptr) {
+            lower[j] = folded;
+        }
+        hash.exact = strhash_detail::step(hash.exact, c);
+        hash.lower = strhash_detail::step(hash.lower, folded);
+    }
+    return hash;
+}
+
+/**
+ * Hash a std::string, both as-is and lowercased
+ */
+static inline variants hash(const std::string& str, char* lower = nullptr)
+{
+    return hash(str.c_str(), str.size(), lower);
+}
+
+/**
+ * Hash a std::string_view, both as-is and lowercased
+ */
+template<typename C>
+static constexpr variants hash(const std::basic_string_view<C>& str, char* lower = nullptr)
+{
+    return hash(str.data(), str.size(), lower);
+}
+} // namespace strhash_multi
+
+// Static unit tests for the adapters
+static_assert(strhash_percent::hash("caf%C3%A9%20au%2flait", 21) == "caf\xc3\xa9 au/lait"_strhash);
+static_assert(strhash_percent::hash("100%", 4) == "100%"_strhash);
+static_assert(strhash_percent::hash("%zz%2", 5) == "%zz%2"_strhash);
+static_assert(strhash_json::hash("a\\\"b\\n\\u00e9\\ud83d\\ude00", 24) == "a\"b\n\xc3\xa9\xf0\x9f\x98\x80"_strhash);
+static_assert(strhash_json::hash("bad\\x\\u12", 9) == "bad\\x\\u12"_strhash);
+static_assert(strhash_trim::hash(" \tkey \n", 7) == "key"_strhash);
+static_assert(strhash_trim::hash("  ", 2) == ""_strhash);
+static_assert(strhash_multi::hash("Hello World", 11).exact == "Hello World"_strhash);
+static_assert(strhash_multi::hash("Hello World", 11).lower == "hello world"_strhash);
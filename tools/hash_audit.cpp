@@ -0,0 +1,310 @@
+/**
+ * Hash quality and table distribution audit of Fnv1-a hashes over a key list.
+ * @comment Reports, for the given keys:
+ * - the avalanche of fnv1a32/64/128 (and of fnv1a64 through the fnv1a_index::mix finalizer): the probability that an
+ *   output bit flips when a single input bit flips, ideally 50%, over all input bits and over the last byte only;
+ * - exact collisions of the full 32, 64 and 128-bit hashes, vs. the birthday bound;
+ * - for fnv1a32, fnv1a64 and folded fnv1a128 hashes, and each table width and index method of fnv1a_index.h: empty
+ *   slots, the longest chain, and the mean linear probing length vs. the one expected from uniform hashing, and the
+ *   index computation time;
+ * - the fastest method whose probe lengths stay within 10% of the expected ones at every width.
+ * Usage: hash_audit [file, one key per line] (the default key lists are words.h and "key:N" sequential keys)
+ * @maintainer xavier dot roche at algolia.com
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../bench/bench.h"
+#include "../fnv1a_index.h"
+#include "../switch_fnv1a.h"
+
+// Over 2^bits slots, as the other methods (on a power of two, it selects the high bits with a multiplication)
+static std::size_t fast_range(uint64_t h, unsigned bits)
+{
+    return fnv1a_index::fast_range(h, std::size_t(1) << bits);
+}
+
+// 32-bit hashes (such as fnv1a32), in the low bits of h: the methods reading the high bits see them at the top
+static std::size_t high_bits32(uint64_t h, unsigned bits)
+{
+    return fnv1a_index::high_bits(h << 32, bits);
+}
+
+static std::size_t fast_range32(uint64_t h, unsigned bits)
+{
+    return fast_range(h << 32, bits);
+}
+
+// Mean index computation time, in nanoseconds
+template<std::size_t (*Index)(uint64_t, unsigned)>
+static double index_time(const std::vector<uint64_t>& hashes, unsigned bits)
+{
+    constexpr std::size_t rounds = 16;
+    std::size_t sum = 0;
+    const uint64_t elapsed = bench::run(rounds, [&] {
+        for (const uint64_t h : hashes) {
+            sum += Index(h, bits);
+        }
+    });
+    bench::keep(sum);
+    return double(elapsed) / double(rounds * hashes.size());
+}
+
+// An index method of fnv1a_index.h, mapping a hash to [0, 2^bits)
+struct method
+{
+    const char* name;
+    std::size_t (*index)(uint64_t, unsigned);
+    double (*time)(const std::vector<uint64_t>&, unsigned);
+};
+
+// By increasing cost
+static const method methods[] = {
+    { "low bits", fnv1a_index::low_bits, index_time<fnv1a_index::low_bits> },
+    { "high bits", fnv1a_index::high_bits, index_time<fnv1a_index::high_bits> },
+    { "xor-fold", fnv1a_index::xor_fold, index_time<fnv1a_index::xor_fold> },
+    { "fibonacci", fnv1a_index::fibonacci, index_time<fnv1a_index::fibonacci> },
+    { "fast-range", fast_range, index_time<fast_range> },
+    { "mix", fnv1a_index::mixed, index_time<fnv1a_index::mixed> },
+};
+
+// The same methods, for 32-bit hashes
+static const method methods32[] = {
+    { "low bits", fnv1a_index::low_bits, index_time<fnv1a_index::low_bits> },
+    { "high bits", high_bits32, index_time<high_bits32> },
+    { "xor-fold", fnv1a_index::xor_fold, index_time<fnv1a_index::xor_fold> },
+    { "fibonacci", fnv1a_index::fibonacci, index_time<fnv1a_index::fibonacci> },
+    { "fast-range", fast_range32, index_time<fast_range32> },
+    { "mix", fnv1a_index::mixed, index_time<fnv1a_index::mixed> },
+};
+static_assert(std::size(methods32) == std::size(methods));
+
+// Output bits of a hash, as up to two 64-bit words
+struct digest
+{
+    uint64_t words[2];
+};
+
+struct avalanche
+{
+    double mean = 0;  // Mean deviation of the flip probabilities from 50%, over the output bits
+    double worst = 0; // Largest deviation
+};
+
+/**
+ * Measure the avalanche of a hash function
+ * @param keys The keys (at most 10,000 are used)
+ * @param bits The number of output bits
+ * @param last_byte Only flip the bits of the last key byte
+ */
+template<typename F>
+static avalanche measure_avalanche(const std::vector<std::string>& keys, unsigned bits, bool last_byte, F&& hash)
+{
+    std::vector<uint64_t> flips(bits, 0);
+    uint64_t trials = 0;
+    const std::size_t step = std::max<std::size_t>(1, keys.size() / 10000);
+    for (std::size_t k = 0; k < keys.size(); k += step) {
+        std::string key = keys[k];
+        if (key.empty()) {
+            continue;
+        }
+        const digest reference = hash(key);
+        for (std::size_t i = last_byte ? key.size() - 1 : 0; i < key.size(); i++) {
+            for (unsigned b = 0; b < 8; b++) {
+                key[i] ^= char(1 << b);
+                const digest flipped = hash(key);
+                key[i] ^= char(1 << b);
+                for (unsigned o = 0; o < bits; o++) {
+                    flips[o] += ((reference.words[o / 64] ^ flipped.words[o / 64]) >> (o % 64)) & 1;
+                }
+                trials++;
+            }
+        }
+    }
+    avalanche result;
+    for (unsigned o = 0; o < bits; o++) {
+        const double deviation = std::fabs(double(flips[o]) / double(trials) - 0.5);
+        result.mean += deviation / bits;
+        result.worst = std::max(result.worst, deviation);
+    }
+    return result;
+}
+
+// Number of keys sharing their hash with a previous key
+template<typename T>
+static std::size_t collisions(std::vector<T> hashes)
+{
+    std::sort(hashes.begin(), hashes.end());
+    return std::size_t(hashes.end() - std::unique(hashes.begin(), hashes.end()));
+}
+
+// Table statistics of an index method at a given width
+struct distribution
+{
+    double empty;    // Empty slots (ratio)
+    std::size_t max; // Longest chain
+    double probes;   // Mean linear probing length of the keys
+};
+
+static distribution measure_distribution(const std::vector<uint64_t>& hashes, const method& m, unsigned bits)
+{
+    const std::size_t size = std::size_t(1) << bits;
+    std::vector<uint32_t> chains(size, 0);
+    std::vector<uint8_t> used(size, 0);
+    uint64_t probes = 0;
+    for (const uint64_t h : hashes) {
+        const std::size_t i = m.index(h, bits);
+        chains[i]++;
+        std::size_t s = i;
+        while (used[s]) {
+            s = (s + 1) & (size - 1);
+            probes++;
+        }
+        used[s] = 1;
+        probes++;
+    }
+    distribution result = { 0, 0, double(probes) / double(hashes.size()) };
+    for (const uint32_t chain : chains) {
+        result.empty += chain == 0 ? 1.0 / double(size) : 0;
+        result.max = std::max<std::size_t>(result.max, chain);
+    }
+    return result;
+}
+
+// Percentage, with two decimals
+static std::string percent(double ratio)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << 100 * ratio << "%";
+    return out.str();
+}
+
+static void audit(const std::string& name, const std::vector<std::string>& keys)
+{
+    std::cout << "== " << name << ": " << keys.size() << " distinct keys\n";
+
+    std::cout << "avalanche: mean / worst output bit deviation from 50% (all input bits | last byte only)\n";
+    const auto report = [&](const char* label, unsigned bits, auto&& hash) {
+        const avalanche all = measure_avalanche(keys, bits, false, hash);
+        const avalanche last = measure_avalanche(keys, bits, true, hash);
+        std::cout << "  " << std::left << std::setw(16) << label << std::right << " " << std::setw(7)
+                  << percent(all.mean) << " / " << std::setw(7) << percent(all.worst) << " | " << std::setw(7)
+                  << percent(last.mean) << " / " << std::setw(7) << percent(last.worst) << "\n";
+    };
+    report("fnv1a32", 32, [](const std::string& key) { return digest{ { fnv1a32::hash(key), 0 } }; });
+    report("fnv1a64", 64, [](const std::string& key) { return digest{ { fnv1a64::hash(key), 0 } }; });
+    report("fnv1a128", 128, [](const std::string& key) {
+        const fnv1a128::Type h = fnv1a128::hash(key);
+        return digest{ { uint64_t(h), uint64_t(h >> 64) } };
+    });
+    report("fnv1a64 + mix", 64, [](const std::string& key) {
+        return digest{ { fnv1a_index::mix(fnv1a64::hash(key)), 0 } };
+    });
+
+    std::vector<uint32_t> hashes32;
+    std::vector<uint64_t> hashes64;
+    std::vector<fnv1a128::Type> hashes128;
+    for (const std::string& key : keys) {
+        hashes32.push_back(fnv1a32::hash(key));
+        hashes64.push_back(fnv1a64::hash(key));
+        hashes128.push_back(fnv1a128::hash(key));
+    }
+    const double pairs = double(keys.size()) * double(keys.size() - 1) / 2;
+    std::cout << std::setprecision(3) << "exact collisions: fnv1a32 " << collisions(hashes32) << " ("
+              << pairs / std::ldexp(1.0, 32) << " expected), fnv1a64 " << collisions(hashes64) << " ("
+              << pairs / std::ldexp(1.0, 64) << " expected), fnv1a128 " << collisions(hashes128) << "\n";
+
+    // Table widths from a full table down to a 1/8 load
+    unsigned min_bits = 4;
+    while ((std::size_t(1) << min_bits) < keys.size() + keys.size() / 8) {
+        min_bits++;
+    }
+    const std::vector<uint64_t> widened(hashes32.begin(), hashes32.end());
+    std::vector<uint64_t> folded(keys.size());
+    std::transform(hashes128.begin(), hashes128.end(), folded.begin(), fnv1a_index::fold);
+    struct hash_set
+    {
+        const char* name;
+        const std::vector<uint64_t>* values;
+        const method* methods;
+    };
+    for (const hash_set& hash : { hash_set{ "fnv1a32", &widened, methods32 },
+                                  hash_set{ "fnv1a64", &hashes64, methods },
+                                  hash_set{ "fnv1a128 folded", &folded, methods } }) {
+        const std::vector<uint64_t>& values = *hash.values;
+        std::cout << "table distribution, " << hash.name
+                  << ": empty slots, longest chain, mean linear probes (expected)\n";
+        const method* best = nullptr;
+        double best_time = 0;
+        for (const method* m = hash.methods; m != hash.methods + std::size(methods); m++) {
+            bool safe = true;
+            for (unsigned bits = min_bits; bits <= min_bits + 3; bits++) {
+                const distribution d = measure_distribution(values, *m, bits);
+                const double load = double(values.size()) / double(std::size_t(1) << bits);
+                const double expected_probes = 0.5 * (1 + 1 / (1 - load));
+                safe &= d.probes <= expected_probes * 1.1;
+                std::cout << "  " << std::left << std::setw(10) << m->name << std::right << " 2^" << std::left
+                          << std::setw(2) << bits << std::right << " (load " << std::fixed << std::setprecision(2)
+                          << load << "): " << std::setw(6) << percent(d.empty) << " (" << std::setw(6)
+                          << percent(std::exp(-load)) << "), " << std::setw(3) << d.max << ", " << std::setw(8)
+                          << d.probes << " (" << expected_probes << ")\n";
+            }
+
+            // Index time, at the largest width
+            const double time = m->time(values, min_bits + 3);
+            std::cout << "  " << std::left << std::setw(10) << m->name << std::right << " " << time << "ns per index"
+                      << (safe ? "" : ", UNSAFE: long probe sequences") << "\n";
+            if (safe && (best == nullptr || time < best_time)) {
+                best = m;
+                best_time = time;
+            }
+            std::cout.unsetf(std::ios::floatfield);
+        }
+        std::cout << "recommended for " << hash.name << ": " << (best != nullptr ? best->name : "none") << "\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::pair<std::string, std::vector<std::string>>> lists;
+    if (argc > 1) {
+        std::ifstream file(argv[1]);
+        if (!file) {
+            std::cerr << "could not open " << argv[1] << "\n";
+            return 1;
+        }
+        std::vector<std::string> keys;
+        for (std::string line; std::getline(file, line);) {
+            keys.push_back(line);
+        }
+        lists.emplace_back(argv[1], keys);
+    } else {
+        lists.emplace_back("words.h", bench::load_words("words.h"));
+        std::vector<std::string> sequential;
+        for (std::size_t i = 0; i < 1000000; i++) {
+            sequential.push_back("key:" + std::to_string(i));
+        }
+        lists.emplace_back("key:N", sequential);
+    }
+
+    for (auto& list : lists) {
+        std::vector<std::string>& keys = list.second;
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        if (keys.size() < 2) {
+            std::cerr << list.first << ": not enough keys\n";
+            return 1;
+        }
+        audit(list.first, keys);
+    }
+    return 0;
+}